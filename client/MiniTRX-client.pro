@@ -9,3 +9,12 @@ RCC_DIR = build
 RESOURCES = qml/MiniTRX-client.qrc
 HEADERS = client.h spectrum.h waterfall.h
 SOURCES = client.cpp spectrum.cpp waterfall.cpp main.cpp
+
+# qmake CONFIG+=offload builds the --offload mode, it needs wdsp and FFTW built for the client target
+offload {
+  DEFINES += OFFLOAD
+  INCLUDEPATH += ../wdsp
+  LIBS += -L../wdsp -lwdsp -lfftw3f
+  HEADERS += offload.h
+  SOURCES += offload.cpp
+}
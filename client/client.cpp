@@ -22,14 +22,17 @@
 
 #include <QQuickItem>
 #include <QStringList>
+#include <QElapsedTimer>
 #include <QtMultimedia/QAudioDeviceInfo>
 #include <QtMultimedia/QAudioInput>
 #include <QtMultimedia/QAudioOutput>
+#include <QtNetwork/QTcpSocket>
 #include <QtWebSockets/QWebSocket>
 
 #include "client.h"
 #include "spectrum.h"
 #include "waterfall.h"
+#include "offload.h"
 
 //------------------------------------------------------------------------------
 
@@ -41,7 +44,11 @@ Client::Client(QObject *parent):
   m_Address(0), m_Connect(0), m_EnableRX(0), m_EnableTX(0), m_EnableFFT(0),
   m_InputDevice(0), m_OutputDevice(0),
 */
-  m_BufferCmd(0), m_Command(0), m_DataInt(0), m_DataFloat(0),
+  m_BufferCmd(0), m_Command(0), m_Sequence(0), m_DataInt(0), m_DataFloat(0),
+  m_Clock(0), m_RoundTrip(0), m_NextFrame(0), m_LostFrames(0),
+  m_BufferNoise(0), m_StateNoise(1),
+  m_Offload(0), m_BufferRX(0),
+  m_LowLatency(false),
   m_AudioFormat(0), m_AudioInput(0), m_AudioOutput(0),
   m_AudioInputDevice(0), m_AudioOutputDevice(0),
   m_WebSocket(0)
@@ -49,8 +56,15 @@ Client::Client(QObject *parent):
   m_BufferCmd = new QByteArray();
   m_BufferCmd->resize(48);
   m_Command = (int32_t *)(m_BufferCmd->constData() + 0);
-  m_DataInt = (int32_t *)(m_BufferCmd->constData() + 4);
-  m_DataFloat = (float *)(m_BufferCmd->constData() + 4);
+  m_Sequence = (uint32_t *)(m_BufferCmd->constData() + 4);
+  m_DataInt = (int32_t *)(m_BufferCmd->constData() + 8);
+  m_DataFloat = (float *)(m_BufferCmd->constData() + 8);
+  *m_Sequence = 0;
+
+  m_Clock = new QElapsedTimer();
+  m_Clock->start();
+
+  m_BufferNoise = new QByteArray();
 /*
   m_LevelRX = findChild<QProgressBar *>("LevelRX");
   m_LevelTX = findChild<QProgressBar *>("LevelTX");
@@ -131,18 +145,101 @@ QStringList Client::inputDeviceList()
 
 //------------------------------------------------------------------------------
 
+void Client::setOffload(bool offload)
+{
+#ifndef OFFLOAD
+  /* built without the wdsp library, the server always demodulates */
+  Q_UNUSED(offload);
+#else
+  if(offload == bool(m_Offload)) return;
+
+  if(!offload)
+  {
+    delete m_Offload;
+    m_Offload = 0;
+    return;
+  }
+
+  m_Offload = new Offload();
+  if(!m_BufferRX) m_BufferRX = new QByteArray();
+  m_BufferRX->resize(1024 * sizeof(int16_t));
+#endif
+}
+
+//------------------------------------------------------------------------------
+
 void Client::sendCommand()
 {
+  /* the server acknowledges every command with its sequence number */
+  ++(*m_Sequence);
+  m_TimeCmd[*m_Sequence % 16] = m_Clock->nsecsElapsed() / 1000;
+#ifdef OFFLOAD
+  if(m_Offload) m_Offload->applyCommand(m_BufferCmd);
+#endif
   if(m_WebSocket) m_WebSocket->sendBinaryMessage(*m_BufferCmd);
 }
 
 //------------------------------------------------------------------------------
 
+void Client::playNoise(int32_t frames, float level)
+{
+  int32_t i, size;
+  int16_t *pointer;
+  float amplitude;
+
+  if(!m_AudioOutputDevice || frames < 1 || frames > 16) return;
+
+  size = frames * 2048;
+  m_BufferNoise->resize(size * sizeof(int16_t));
+  pointer = (int16_t *)(m_BufferNoise->constData());
+
+  /* uniform noise with the given RMS level */
+  amplitude = level * 1.7320508;
+  if(amplitude > 32767.0) amplitude = 32767.0;
+  for(i = 0; i < size; ++i)
+  {
+    m_StateNoise = m_StateNoise * 1664525 + 1013904223;
+    *(pointer++) = int16_t(amplitude * (float(int32_t(m_StateNoise)) / 2147483648.0));
+  }
+
+  m_AudioOutputDevice->write(m_BufferNoise->constData(), size * sizeof(int16_t));
+}
+
+//------------------------------------------------------------------------------
+
 void Client::on_StartRX_clicked()
 {
+  /* four frames of 256 samples in low latency mode */
+  m_AudioOutput->setBufferSize(m_LowLatency ? 4096 : 16384);
   m_AudioOutputDevice = m_AudioOutput->start();
+#ifdef OFFLOAD
+  if(m_Offload) m_Offload->start();
+#endif
   *m_Command = 1;
   sendCommand();
+  if(m_LowLatency)
+  {
+    *m_Command = 35;
+    m_DataInt[0] = 256;
+    m_DataInt[1] = 1;
+    sendCommand();
+  }
+  if(m_Offload)
+  {
+    /* only the 12-bit IQ, the audio is demodulated here */
+    *m_Command = 33;
+    m_DataInt[0] = 1;
+    m_DataInt[1] = 12;
+    m_DataInt[2] = 1;
+    m_DataFloat[3] = 0.0;
+    m_DataInt[4] = 1;
+    sendCommand();
+    return;
+  }
+  /* comfort noise is generated here, so the server may stop sending muted audio */
+  *m_Command = 31;
+  m_DataInt[0] = 1;
+  sendCommand();
 }
 
 //------------------------------------------------------------------------------
@@ -201,6 +298,14 @@ void Client::on_Disconnect_clicked()
 
 void Client::on_WebSocket_connected()
 {
+  QTcpSocket *socket = m_WebSocket->findChild<QTcpSocket *>();
+
+  m_NextFrame = 0;
+  m_LostFrames = 0;
+
+  /* the commands are small, send them without waiting for more data */
+  if(socket && m_LowLatency) socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
   connect(m_WebSocket, SIGNAL(binaryMessageReceived(QByteArray)), this, SLOT(on_WebSocket_binaryMessageReceived(QByteArray)));
 }
 
@@ -215,7 +320,17 @@ void Client::on_WebSocket_disconnected()
 
 void Client::on_WebSocket_binaryMessageReceived(QByteArray message)
 {
-  int32_t command;
+  int32_t command, size;
+  uint32_t sequence;
+
+  if(message.size() < 24) return;
+
+  /* count the gaps in the sequence numbers, then drop the header past the type */
+  sequence = *(uint32_t *)(message.constData() + 4);
+  if(sequence != m_NextFrame) m_LostFrames += sequence - m_NextFrame;
+  m_NextFrame = sequence + 1;
+  message.remove(4, 20);
+
   command = *(int32_t *)(message.constData() + 0);
   switch(command)
   {
@@ -228,6 +343,30 @@ void Client::on_WebSocket_binaryMessageReceived(QByteArray message)
       if(m_Spectrum) m_Spectrum->setData((uint8_t *)(message.constData() + 4));
       if(m_Waterfall) m_Waterfall->setData((uint8_t *)(message.constData() + 4));
       break;
+    case 5:
+      // comfort noise descriptor
+      playNoise(*(int32_t *)(message.constData() + 4), *(float *)(message.constData() + 8));
+      break;
+    case 7:
+      // IQ data
+#ifdef OFFLOAD
+      if(!m_Offload) break;
+      size = m_Offload->process(message, (int16_t *)(m_BufferRX->constData()));
+      if(m_AudioOutputDevice && size > 0) m_AudioOutputDevice->write(m_BufferRX->constData(), size * sizeof(int16_t));
+#endif
+      break;
+    case 8:
+      // RX data in a negotiated format, only the output format is played
+      if(*(int32_t *)(message.constData() + 4) != 22050) break;
+      if(*(uint8_t *)(message.constData() + 8) != 2 || *(uint8_t *)(message.constData() + 9) != 0) break;
+      size = *(uint16_t *)(message.constData() + 10) * 2;
+      if(m_AudioOutputDevice && message.size() == int(size * sizeof(int16_t)) + 12) m_AudioOutputDevice->write(message.constData() + 12, size * sizeof(int16_t));
+      break;
+    case 9:
+      // command acknowledgement
+      sequence = *(uint32_t *)(message.constData() + 4);
+      if(*m_Sequence - sequence < 16) m_RoundTrip = m_Clock->nsecsElapsed() / 1000 - m_TimeCmd[sequence % 16];
+      break;
   }
 }
 
@@ -30,11 +30,13 @@ class QByteArray;
 class QAudioFormat;
 class QAudioInput;
 class QAudioOutput;
+class QElapsedTimer;
 class QIODevice;
 class QWebSocket;
 
 class Spectrum;
 class Waterfall;
+class Offload;
 
 class Client: public QObject
 {
@@ -46,9 +48,13 @@ public:
 
   void setSpectrum(Spectrum *spectrum) { m_Spectrum = spectrum; }
   void setWaterfall(Waterfall *waterfall) { m_Waterfall = waterfall; }
+  void setOffload(bool offload);
+  void setLowLatency(bool lowLatency) { m_LowLatency = lowLatency; }
 
   Q_INVOKABLE QStringList outputDeviceList();
   Q_INVOKABLE QStringList inputDeviceList();
+  Q_INVOKABLE int roundTrip() { return m_RoundTrip; }
+  Q_INVOKABLE int lostFrames() { return m_LostFrames; }
 
 public slots:
   void on_Connect_clicked(QString address);
@@ -80,15 +86,31 @@ private slots:
 
 private:
   void sendCommand();
+  void playNoise(int32_t frames, float level);
 
   Spectrum *m_Spectrum;
   Waterfall *m_Waterfall;
 
   QByteArray *m_BufferCmd;
   int32_t *m_Command;
+  uint32_t *m_Sequence;
   int32_t *m_DataInt;
   float *m_DataFloat;
 
+  QElapsedTimer *m_Clock;
+  int64_t m_TimeCmd[16];
+  int32_t m_RoundTrip;
+  uint32_t m_NextFrame;
+  int32_t m_LostFrames;
+
+  QByteArray *m_BufferNoise;
+  uint32_t m_StateNoise;
+
+  Offload *m_Offload;
+  QByteArray *m_BufferRX;
+
+  bool m_LowLatency;
+
   QStringList m_InputDeviceList;
   QList<QAudioDeviceInfo> m_InputDeviceInfoList;
   QStringList m_OutputDeviceList;
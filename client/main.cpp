@@ -35,6 +35,11 @@ int main(int argc, char *argv[])
   qmlRegisterType<Spectrum>("MiniTRX", 1, 0, "Spectrum");
   qmlRegisterType<Waterfall>("MiniTRX", 1, 0, "Waterfall");
 
+  /* demodulate the IQ from the server locally */
+  client.setOffload(app.arguments().contains("--offload"));
+  /* small audio frames and buffers */
+  client.setLowLatency(app.arguments().contains("--low-latency"));
+
   view.rootContext()->setContextProperty("client", &client);
   view.setSource(QUrl("qrc:/MiniTRX-client.qml"));
 
@@ -0,0 +1,201 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+#include <QByteArray>
+
+#include <fftw3.h>
+
+extern "C"
+{
+  #include "comm.h"
+}
+
+#include "offload.h"
+
+//------------------------------------------------------------------------------
+
+Offload::Offload():
+  m_Buffer(0), m_Resample(0)
+{
+  FILE *wisdomFile;
+
+  /* same RXA channel and defaults as on the server */
+  if((wisdomFile = fopen("wdsp-fftw-wisdom.txt", "r")))
+  {
+    fftwf_import_wisdom_from_file(wisdomFile);
+    fclose(wisdomFile);
+  }
+  OpenChannel(0, 256, 4096, 20000, 20000, 20000, 0, 0, 0.010, 0.025, 0.000, 0.010, 0);
+  if((wisdomFile = fopen("wdsp-fftw-wisdom.txt", "w")))
+  {
+    fftwf_export_wisdom_to_file(wisdomFile);
+    fclose(wisdomFile);
+  }
+
+  SetRXAShiftRun(0, 0);
+  SetRXAAMDRun(0, 1);
+  SetRXAMode(0, RXA_AM);
+  SetRXABandpassFreqs(0, -5000.0, 5000.0);
+  SetRXAAGCFixed(0, 30.0);
+  SetRXAAGCTop(0, 30.0);
+  SetRXAEMNRRun(0, 0);
+
+  /* IQ input, RXA output and audio at 22050 Hz */
+  m_Buffer = new float[2048];
+  m_Resample = create_resample(1, 256, m_Buffer + 512, m_Buffer + 1024, 20000, 22050, 0.0, 0, 1.0);
+}
+
+//------------------------------------------------------------------------------
+
+Offload::~Offload()
+{
+  CloseChannel(0);
+  destroy_resample(m_Resample);
+  delete [] m_Buffer;
+}
+
+//------------------------------------------------------------------------------
+
+void Offload::start()
+{
+  SetChannelState(0, 1, 0);
+}
+
+//------------------------------------------------------------------------------
+
+void Offload::applyCommand(const QByteArray *message)
+{
+  int32_t command;
+  int32_t *dataInt;
+  float *dataFloat;
+
+  command = *(int32_t *)(message->constData() + 0);
+  dataInt = (int32_t *)(message->constData() + 8);
+  dataFloat = (float *)(message->constData() + 8);
+
+  /* the RXA commands of the server, applied to the local channel */
+  switch(command)
+  {
+    case 11:
+      // set RX mode
+      if(dataInt[0] < 0 || dataInt[0] > 11) break;
+      SetRXAMode(0, dataInt[0]);
+      break;
+    case 13:
+      // set RX filter
+      if(dataFloat[0] < -9.0e3 || dataFloat[0] > 9.0e3) break;
+      if(dataFloat[1] < -9.0e3 || dataFloat[1] > 9.0e3) break;
+      SetRXABandpassFreqs(0, dataFloat[0], dataFloat[1]);
+      break;
+    case 15:
+      // set RX AGC mode
+      if(dataInt[0] < 0 || dataInt[0] > 5) break;
+      SetRXAAGCMode(0, dataInt[0]);
+      break;
+    case 16:
+      // set RX AGC fixed gain
+      if(dataFloat[0] < 0.0 || dataFloat[0] > 120.0) break;
+      SetRXAAGCFixed(0, dataFloat[0]);
+      break;
+    case 17:
+      // set RX AGC top gain
+      if(dataFloat[0] < 0.0 || dataFloat[0] > 120.0) break;
+      SetRXAAGCTop(0, dataFloat[0]);
+      break;
+    case 18:
+      // set RX AGC slope
+      if(dataInt[0] < 0 || dataInt[0] > 20) break;
+      SetRXAAGCSlope(0, dataInt[0]);
+      break;
+    case 19:
+      // set RX AGC decay
+      if(dataInt[0] < 0 || dataInt[0] > 10000) break;
+      SetRXAAGCDecay(0, dataInt[0]);
+      break;
+    case 20:
+      // set RX AGC hang
+      if(dataInt[0] < 0 || dataInt[0] > 10000) break;
+      SetRXAAGCHang(0, dataInt[0]);
+      break;
+    case 21:
+      // set RX AGC hang threshold
+      if(dataInt[0] < 0 || dataInt[0] > 100) break;
+      SetRXAAGCHangThreshold(0, dataInt[0]);
+      break;
+    case 29:
+      // set RX AM squelch run and threshold
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataFloat[1] < -160.0 || dataFloat[1] > 0.0) break;
+      SetRXAAMSQThreshold(0, dataFloat[1]);
+      SetRXAAMSQRun(0, dataInt[0]);
+      break;
+    case 30:
+      // set RX FM squelch run and threshold
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataFloat[1] < 0.0 || dataFloat[1] > 1.0) break;
+      SetRXAFMSQThreshold(0, dataFloat[1]);
+      SetRXAFMSQRun(0, dataInt[0]);
+      break;
+    case 40:
+      // set RX noise blanker run and threshold relative to the average magnitude
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataFloat[1] < 1.0 || dataFloat[1] > 100.0) break;
+      SetRXAANBThreshold(0, dataFloat[1]);
+      SetRXAANBRun(0, dataInt[0]);
+      break;
+    case 41:
+      // set RX noise blanker hang and advance times in ms
+      if(dataFloat[0] < 0.0 || dataFloat[0] > 10.0) break;
+      if(dataFloat[1] < 0.0 || dataFloat[1] > 2.0) break;
+      SetRXAANBHangtime(0, dataFloat[0] * 1.0e-3);
+      SetRXAANBAdvtime(0, dataFloat[1] * 1.0e-3);
+      break;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+int32_t Offload::process(const QByteArray &message, int16_t *audio)
+{
+  int32_t i, size, bits, block, error;
+
+  size = *(uint16_t *)(message.constData() + 8);
+  bits = *(uint8_t *)(message.constData() + 10);
+  block = *(uint8_t *)(message.constData() + 11);
+
+  if(size != 256 || block < 1 || message.size() < bfp_size(size, bits, block) + 12) return 0;
+
+  /* the local channel runs at the default RX rate only */
+  if(*(int32_t *)(message.constData() + 4) != 20000) return 0;
+
+  bfp_unpack(size, (unsigned char *)(message.constData() + 12), bits, block, m_Buffer, 1.0 / 536870911.0);
+
+  fexchange0(0, m_Buffer, m_Buffer + 512, &error);
+  size = xresample(m_Resample);
+
+  for(i = 0; i < size * 2; ++i)
+  {
+    *(audio++) = int16_t(floor(m_Buffer[1024 + i] * 32767.0 + 0.5));
+  }
+
+  return size * 2;
+}
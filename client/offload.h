@@ -0,0 +1,47 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Offload_h
+#define Offload_h
+
+#include <stdint.h>
+
+class QByteArray;
+
+struct _resample;
+
+// Local wdsp RXA channel demodulating the compressed IQ sent by the server
+// (frame type 7).  It is kept apart from the rest of the client because the
+// wdsp headers clash with the Qt and client names.
+
+class Offload
+{
+public:
+  Offload();
+  ~Offload();
+
+  void start();
+  void applyCommand(const QByteArray *command);
+  int32_t process(const QByteArray &message, int16_t *audio);
+
+private:
+  float *m_Buffer;
+  struct _resample *m_Resample;
+};
+
+#endif
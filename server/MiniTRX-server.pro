@@ -10,5 +10,5 @@ QMAKE_LFLAGS += -static
 OBJECTS_DIR = build
 MOC_DIR = build
 RCC_DIR = build
-HEADERS = server.h
-SOURCES = server.cpp main.cpp
+HEADERS = server.h session.h panorama.h detector.h audiogroup.h waterfall.h iqstream.h
+SOURCES = server.cpp session.cpp panorama.cpp detector.cpp audiogroup.cpp waterfall.cpp iqstream.cpp main.cpp
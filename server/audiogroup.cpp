@@ -0,0 +1,240 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "audiogroup.h"
+
+//------------------------------------------------------------------------------
+
+static uint8_t encodeMuLaw(int32_t value)
+{
+  int32_t sign, exponent, mantissa;
+
+  /* G.711 segment encoding of a 14-bit magnitude with bias 132 */
+  sign = 0;
+  if(value < 0)
+  {
+    sign = 0x80;
+    value = -value;
+  }
+  if(value > 32635) value = 32635;
+  value += 0x84;
+
+  exponent = 7;
+  while(exponent > 0 && !(value & (0x80 << exponent))) --exponent;
+  mantissa = (value >> (exponent + 3)) & 0x0F;
+
+  return ~(sign | (exponent << 4) | mantissa);
+}
+
+//------------------------------------------------------------------------------
+
+AudioGroup::AudioGroup(int32_t rate, int32_t channels, int32_t format, int32_t frames, bool dtx):
+  m_Rate(rate), m_Channels(channels), m_Format(format), m_Frames(frames), m_DTX(dtx),
+  m_InputRate(20000),
+  m_Header(4), m_Size(frames * channels), m_Counter(0),
+  m_Pointer(0), m_Energy(0.0), m_Level(0.0),
+  m_Input(0), m_Output(0), m_Offset(0), m_State(0),
+  m_Frame(0), m_Preroll(0),
+  m_Silent(false), m_Hang(0), m_Quiet(0),
+  m_HangFrames(0), m_NoiseFrames(0)
+{
+  int32_t width, error;
+
+  width = m_Format == Float32 ? 4 : m_Format == Int16 ? 2 : 1;
+
+  if(!matches(DefaultRate, DefaultChannels, DefaultFormat, DefaultFrames, m_DTX)) m_Header = 12;
+
+  /* the hang time and the noise descriptor period do not depend on the frame size */
+  m_HangFrames = 6 * DefaultFrames / m_Frames;
+  m_NoiseFrames = 4 * DefaultFrames / m_Frames;
+
+  m_Frame = new QByteArray();
+  m_Frame->resize(m_Size * width + m_Header);
+  if(m_Header == 4)
+  {
+    *(uint32_t *)(m_Frame->constData() + 0) = 0;
+  }
+  else
+  {
+    *(uint32_t *)(m_Frame->constData() + 0) = 8;
+    *(int32_t *)(m_Frame->constData() + 4) = m_Rate;
+    *(uint8_t *)(m_Frame->constData() + 8) = m_Channels;
+    *(uint8_t *)(m_Frame->constData() + 9) = m_Format;
+    *(uint16_t *)(m_Frame->constData() + 10) = m_Frames;
+  }
+
+  m_Preroll = new QByteArray();
+  m_Preroll->resize(m_Frame->size());
+
+  m_Pointer = (char *)(m_Frame->constData() + m_Header);
+
+  /* downmix before resampling, mono needs half of the filtering */
+  if(m_Channels == 1) m_Input = new float[256];
+
+  m_State = src_new(SRC_SINC_FASTEST, m_Channels, &error);
+
+  m_Data.data_in = m_Input;
+  m_Data.input_frames = 256;
+
+  /* the RXA output rate is never below 20 kHz */
+  m_Data.output_frames = 256 * m_Rate / 20000 + 1;
+  m_Output = new float[m_Data.output_frames * m_Channels];
+  m_Data.data_out = m_Output;
+  m_Data.output_frames_gen = 0;
+  m_Data.src_ratio = m_Rate / 20000.0;
+  m_Data.end_of_input = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void AudioGroup::setInputRate(int32_t rate)
+{
+  if(m_InputRate == rate) return;
+
+  m_InputRate = rate;
+  m_Data.src_ratio = double(m_Rate) / m_InputRate;
+  src_reset(m_State);
+}
+
+//------------------------------------------------------------------------------
+
+AudioGroup::~AudioGroup()
+{
+  if(m_State) src_delete(m_State);
+  delete [] m_Input;
+  delete [] m_Output;
+  delete m_Frame;
+  delete m_Preroll;
+}
+
+//------------------------------------------------------------------------------
+
+bool AudioGroup::matches(int32_t rate, int32_t channels, int32_t format, int32_t frames, bool dtx) const
+{
+  return m_Rate == rate && m_Channels == channels && m_Format == format && m_Frames == frames && m_DTX == dtx;
+}
+
+//------------------------------------------------------------------------------
+
+void AudioGroup::convert(float *input, int32_t frames)
+{
+  int32_t i;
+
+  if(m_Channels == 1)
+  {
+    for(i = 0; i < frames; ++i)
+    {
+      m_Input[i] = 0.5 * (input[2 * i] + input[2 * i + 1]);
+    }
+  }
+  else
+  {
+    m_Data.data_in = input;
+  }
+
+  m_Data.input_frames = frames;
+  m_Data.output_frames = frames * m_Rate / m_InputRate + 1;
+  src_process(m_State, &m_Data);
+  m_Offset = 0;
+}
+
+//------------------------------------------------------------------------------
+
+bool AudioGroup::fill()
+{
+  int32_t total, value;
+  int16_t sample;
+  float input;
+
+  total = m_Data.output_frames_gen * m_Channels;
+  while(m_Offset < total)
+  {
+    input = m_Output[m_Offset++];
+    switch(m_Format)
+    {
+      case Int16:
+        sample = int16_t(floor(input * 32767.0 + 0.5));
+        *(int16_t *)m_Pointer = sample;
+        m_Pointer += 2;
+        m_Energy += float(sample) * float(sample);
+        break;
+      case Float32:
+        *(float *)m_Pointer = input;
+        m_Pointer += 4;
+        m_Energy += (input * 32767.0) * (input * 32767.0);
+        break;
+      case MuLaw:
+        value = int32_t(floor(input * 32767.0 + 0.5));
+        if(value > 32767) value = 32767;
+        if(value < -32768) value = -32768;
+        *(uint8_t *)m_Pointer = encodeMuLaw(value);
+        m_Pointer += 1;
+        m_Energy += float(value) * float(value);
+        break;
+    }
+
+    if(++m_Counter == m_Size)
+    {
+      /* RMS level in int16 units for the comfort noise descriptor */
+      m_Level = sqrt(m_Energy / double(m_Size));
+      m_Energy = 0.0;
+      m_Counter = 0;
+      m_Pointer = (char *)(m_Frame->constData() + m_Header);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//------------------------------------------------------------------------------
+
+int32_t AudioGroup::gate(bool muted)
+{
+  int32_t result;
+
+  /* the squelch state leads the audio by up to one DSP buffer (about 4.5 frames) */
+  if(!m_DTX || !muted)
+  {
+    result = m_Silent ? Preroll | Frame : Frame;
+    m_Silent = false;
+    m_Hang = m_HangFrames;
+    return result;
+  }
+
+  if(m_Hang > 0)
+  {
+    --m_Hang;
+    return Frame;
+  }
+
+  /* keep the last muted frame as pre-roll for the next unmute */
+  memcpy((char *)m_Preroll->constData(), m_Frame->constData(), m_Frame->size());
+
+  if(!m_Silent) m_Quiet = 0;
+  m_Silent = true;
+
+  /* one comfort noise descriptor for every four frames of the default size */
+  if(m_Quiet++ % m_NoiseFrames != 0) return 0;
+
+  return Noise;
+}
@@ -0,0 +1,103 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AudioGroup_h
+#define AudioGroup_h
+
+#include <stdint.h>
+
+#include <QtCore/QList>
+#include <QtCore/QByteArray>
+
+#include <samplerate.h>
+
+class QWebSocket;
+
+// Audio output shared by all clients that asked for the same rate, number
+// of channels, sample format, frame size and discontinuous transmission
+// setting.  The stereo RXA output is converted once per group with a fixed
+// ratio resampler, and the frames of the groups with DTX are gated once per
+// group.  The default group
+// (22050 Hz, stereo, int16, 1024 samples) keeps the original audio frames of
+// type 0, the other groups send frames of type 8 with the format in the
+// header.  Smaller frames lower the latency at the cost of more overhead.
+
+class AudioGroup
+{
+public:
+  enum Format
+  {
+    Int16 = 0,
+    Float32 = 1,
+    MuLaw = 2
+  };
+
+  enum Gate
+  {
+    Frame = 1,
+    Preroll = 2,
+    Noise = 4
+  };
+
+  static const int32_t DefaultRate = 22050;
+  static const int32_t DefaultChannels = 2;
+  static const int32_t DefaultFormat = Int16;
+  static const int32_t DefaultFrames = 1024;
+
+  AudioGroup(int32_t rate, int32_t channels, int32_t format, int32_t frames, bool dtx);
+  ~AudioGroup();
+
+  bool matches(int32_t rate, int32_t channels, int32_t format, int32_t frames, bool dtx) const;
+
+  void setInputRate(int32_t rate);
+  void convert(float *input, int32_t frames);
+  bool fill();
+  int32_t gate(bool muted);
+  bool dtx() const { return m_DTX; }
+
+  QByteArray *frame() { return m_Frame; }
+  QByteArray *preroll() { return m_Preroll; }
+  float level() const { return m_Level; }
+
+  int32_t rate() const { return m_Rate; }
+  int32_t channels() const { return m_Channels; }
+  int32_t format() const { return m_Format; }
+  int32_t frames() const { return m_Frames; }
+
+  QList<QWebSocket *> &clients() { return m_Clients; }
+
+private:
+  int32_t m_Rate, m_Channels, m_Format, m_Frames;
+  bool m_DTX;
+  int32_t m_InputRate;
+  int32_t m_Header, m_Size, m_Counter;
+  char *m_Pointer;
+  float m_Energy, m_Level;
+  float *m_Input, *m_Output;
+  int32_t m_Offset;
+  SRC_STATE *m_State;
+  SRC_DATA m_Data;
+  QByteArray *m_Frame;
+  QByteArray *m_Preroll;
+  bool m_Silent;
+  int32_t m_Hang, m_Quiet;
+  int32_t m_HangFrames, m_NoiseFrames;
+  QList<QWebSocket *> m_Clients;
+};
+
+#endif
@@ -0,0 +1,218 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include "detector.h"
+
+//------------------------------------------------------------------------------
+
+Detector::Detector(int32_t size):
+  m_Size(size),
+  m_Method(CellAveraging), m_Threshold(10), m_Guard(4), m_Reference(16), m_Hold(10),
+  m_Frame(0), m_Sum(0), m_SNR(0), m_Count(0)
+{
+  m_Sum = new int32_t[m_Size + 1];
+  m_SNR = new int16_t[m_Size];
+}
+
+//------------------------------------------------------------------------------
+
+Detector::~Detector()
+{
+  delete [] m_Sum;
+  delete [] m_SNR;
+}
+
+//------------------------------------------------------------------------------
+
+void Detector::configure(int32_t method, int32_t threshold, int32_t guard, int32_t reference, int32_t hold)
+{
+  m_Method = method;
+  m_Threshold = threshold;
+  m_Guard = guard;
+  m_Reference = reference;
+  m_Hold = hold;
+  m_Count = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void Detector::process(const uint8_t *bins)
+{
+  int32_t i, start, width, snr, level, peak;
+
+  ++m_Frame;
+
+  if(m_Method == OrderedStatistic) estimateOrdered(bins);
+  else estimateMean(bins);
+
+  // merge adjacent bins above the threshold
+  start = -1;
+  snr = 0;
+  level = 255;
+  peak = 0;
+  for(i = 0; i <= m_Size; ++i)
+  {
+    if(i < m_Size && m_SNR[i] >= m_Threshold)
+    {
+      if(start < 0) start = i;
+      if(bins[i] < level)
+      {
+        level = bins[i];
+        peak = i;
+      }
+      if(m_SNR[i] > snr) snr = m_SNR[i];
+    }
+    else if(start >= 0)
+    {
+      width = i - start;
+      track(peak, width, snr, level);
+      start = -1;
+      snr = 0;
+      level = 255;
+    }
+  }
+
+  // drop the detections that have not been seen for too long
+  for(i = 0; i < m_Count;)
+  {
+    if(m_Frame - m_Detections[i].last > uint32_t(m_Hold))
+    {
+      m_Detections[i] = m_Detections[--m_Count];
+    }
+    else
+    {
+      ++i;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Detector::estimateMean(const uint8_t *bins)
+{
+  int32_t i, a0, a1, b0, b1, n, sum, lo, hi;
+  int32_t guard = m_Guard, reference = m_Reference;
+
+  m_Sum[0] = 0;
+  for(i = 0; i < m_Size; ++i) m_Sum[i + 1] = m_Sum[i] + bins[i];
+
+  lo = guard + reference;
+  hi = m_Size - guard - reference;
+
+  // both windows are complete, no branches in the loop
+  n = 2 * reference;
+  for(i = lo; i < hi; ++i)
+  {
+    sum = m_Sum[i - guard] - m_Sum[i - guard - reference] + m_Sum[i + guard + reference + 1] - m_Sum[i + guard + 1];
+    m_SNR[i] = (sum - n * bins[i]) / n;
+  }
+
+  // edges, one of the windows is clipped
+  for(i = 0; i < m_Size; ++i)
+  {
+    if(i == lo && hi > lo) i = hi;
+    a0 = i - guard - reference;
+    a1 = i - guard;
+    b0 = i + guard + 1;
+    b1 = i + guard + reference + 1;
+    if(a0 < 0) a0 = 0;
+    if(a1 < 0) a1 = 0;
+    if(b0 > m_Size) b0 = m_Size;
+    if(b1 > m_Size) b1 = m_Size;
+    n = (a1 - a0) + (b1 - b0);
+    if(n == 0)
+    {
+      m_SNR[i] = 0;
+      continue;
+    }
+    sum = m_Sum[a1] - m_Sum[a0] + m_Sum[b1] - m_Sum[b0];
+    m_SNR[i] = (sum - n * bins[i]) / n;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Detector::estimateOrdered(const uint8_t *bins)
+{
+  int32_t i, j, k, n, value;
+  int32_t guard = m_Guard, reference = m_Reference;
+  int32_t histogram[256];
+
+  memset(histogram, 0, sizeof(histogram));
+
+  n = 0;
+  for(j = guard + 1; j <= guard + reference && j < m_Size; ++j)
+  {
+    ++histogram[bins[j]];
+    ++n;
+  }
+
+  for(i = 0; i < m_Size; ++i)
+  {
+    // lower quartile of the attenuations, upper quartile of the powers
+    k = n / 4;
+    for(value = 0; value < 255; ++value)
+    {
+      k -= histogram[value];
+      if(k < 0) break;
+    }
+    m_SNR[i] = n > 0 ? value - bins[i] : 0;
+
+    j = i - guard - reference;
+    if(j >= 0) { --histogram[bins[j]]; --n; }
+    j = i - guard;
+    if(j >= 0) { ++histogram[bins[j]]; ++n; }
+    j = i + guard + 1;
+    if(j < m_Size) { --histogram[bins[j]]; --n; }
+    j = i + guard + reference + 1;
+    if(j < m_Size) { ++histogram[bins[j]]; ++n; }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Detector::track(int32_t bin, int32_t width, int32_t snr, int32_t level)
+{
+  int32_t i, distance, limit;
+  Detection *detection;
+
+  for(i = 0; i < m_Count; ++i)
+  {
+    detection = m_Detections + i;
+    distance = bin - detection->bin;
+    if(distance < 0) distance = -distance;
+    limit = (width > detection->width ? width : detection->width) / 2 + 1;
+    if(distance <= limit && detection->last != m_Frame) break;
+  }
+
+  if(i == m_Count)
+  {
+    if(m_Count == MaxDetections) return;
+    detection = m_Detections + m_Count++;
+    detection->first = m_Frame;
+  }
+
+  detection->bin = bin;
+  detection->width = width;
+  detection->snr = snr;
+  detection->level = level;
+  detection->last = m_Frame;
+}
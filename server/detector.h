@@ -0,0 +1,74 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Detector_h
+#define Detector_h
+
+#include <stdint.h>
+
+// CFAR detector working on the FFT frames (attenuations in dB, so the
+// strongest signal has the lowest value).  The noise level of every bin is
+// estimated from 'reference' bins on each side, skipping 'guard' bins next
+// to it, either as their mean (cell averaging) or as their lower quartile
+// (ordered statistic).  Adjacent bins above the threshold are merged into
+// one detection, and detections are tracked across frames until they have
+// not been seen for 'hold' frames.
+
+class Detector
+{
+public:
+  enum Method
+  {
+    CellAveraging = 0,
+    OrderedStatistic = 1
+  };
+
+  struct Detection
+  {
+    uint16_t bin, width;
+    uint16_t snr, level;
+    uint32_t first, last;
+  };
+
+  static const int32_t MaxDetections = 256;
+
+  Detector(int32_t size);
+  ~Detector();
+
+  void configure(int32_t method, int32_t threshold, int32_t guard, int32_t reference, int32_t hold);
+  void process(const uint8_t *bins);
+
+  uint32_t frame() const { return m_Frame; }
+  int32_t count() const { return m_Count; }
+  const Detection *detections() const { return m_Detections; }
+
+private:
+  void estimateMean(const uint8_t *bins);
+  void estimateOrdered(const uint8_t *bins);
+  void track(int32_t bin, int32_t width, int32_t snr, int32_t level);
+
+  int32_t m_Size;
+  int32_t m_Method, m_Threshold, m_Guard, m_Reference, m_Hold;
+  uint32_t m_Frame;
+  int32_t *m_Sum;
+  int16_t *m_SNR;
+  int32_t m_Count;
+  Detection m_Detections[MaxDetections];
+};
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <QtCore/QByteArray>
+
+extern "C"
+{
+  #include "comm.h"
+}
+
+#include "iqstream.h"
+
+//------------------------------------------------------------------------------
+
+IQStream::IQStream(int32_t bits, int32_t decimation, float shift, int32_t rate):
+  m_Bits(bits), m_Decimation(decimation), m_Shift(shift), m_Rate(0),
+  m_Buffer(0), m_Samples(0), m_ShiftState(0), m_Resample(0), m_Frame(0)
+{
+  m_Buffer = new float[1024];
+  m_Samples = new int32_t[512];
+  m_Frame = new QByteArray();
+  setRate(rate);
+}
+
+//------------------------------------------------------------------------------
+
+IQStream::~IQStream()
+{
+  if(m_ShiftState) destroy_shift(m_ShiftState);
+  if(m_Resample) destroy_resample(m_Resample);
+  delete [] m_Buffer;
+  delete [] m_Samples;
+  delete m_Frame;
+}
+
+//------------------------------------------------------------------------------
+
+void IQStream::setRate(int32_t rate)
+{
+  if(m_ShiftState) destroy_shift(m_ShiftState);
+  if(m_Resample) destroy_resample(m_Resample);
+  m_ShiftState = 0;
+  m_Resample = 0;
+
+  m_Rate = rate;
+  m_ShiftState = create_shift(m_Shift != 0.0, 256, m_Buffer, m_Buffer + 512, m_Rate, m_Shift);
+  /* decimating in place is safe, no output sample overtakes its input */
+  if(m_Decimation > 1) m_Resample = create_resample(1, 256, m_Buffer + 512, m_Buffer + 512, m_Rate, m_Rate / m_Decimation, 0.0, 0, 1.0);
+}
+
+//------------------------------------------------------------------------------
+
+void IQStream::process(const float *buffer)
+{
+  int32_t i, size;
+  float value;
+
+  memcpy(m_Buffer, buffer, 512 * sizeof(float));
+  xshift(m_ShiftState);
+  size = 256;
+  if(m_Resample) size = xresample(m_Resample);
+
+  /* back to the scale of the FPGA samples */
+  for(i = 0; i < 2 * size; ++i)
+  {
+    value = m_Buffer[512 + i] * 536870911.0;
+    if(value > 2147483520.0) value = 2147483520.0;
+    if(value < -2147483520.0) value = -2147483520.0;
+    m_Samples[i] = int32_t(value);
+  }
+
+  m_Frame->resize(bfp_size(size, m_Bits, 32) + 12);
+  *(uint32_t *)(m_Frame->constData() + 0) = 7;
+  *(int32_t *)(m_Frame->constData() + 4) = m_Rate / m_Decimation;
+  *(uint16_t *)(m_Frame->constData() + 8) = size;
+  *(uint8_t *)(m_Frame->constData() + 10) = m_Bits;
+  *(uint8_t *)(m_Frame->constData() + 11) = 32;
+  bfp_pack(size, m_Samples, m_Bits, 32, (unsigned char *)(m_Frame->constData() + 12));
+}
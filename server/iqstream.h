@@ -0,0 +1,57 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IQStream_h
+#define IQStream_h
+
+#include <stdint.h>
+
+#include <QtCore/QByteArray>
+
+struct _shift;
+struct _resample;
+
+// IQ frames for an offloading client.  The RX samples are shifted by the
+// frequency offset of the client, decimated and packed as block floating
+// point with the mantissa bits it asked for.  Every subscriber keeps its own
+// filter state, so the clients do not disturb each other.
+
+class IQStream
+{
+public:
+  IQStream(int32_t bits, int32_t decimation, float shift, int32_t rate);
+  ~IQStream();
+
+  void setRate(int32_t rate);
+
+  void process(const float *buffer);
+
+  QByteArray *frame() { return m_Frame; }
+
+private:
+  int32_t m_Bits, m_Decimation;
+  float m_Shift;
+  int32_t m_Rate;
+  float *m_Buffer;
+  int32_t *m_Samples;
+  struct _shift *m_ShiftState;
+  struct _resample *m_Resample;
+  QByteArray *m_Frame;
+};
+
+#endif
@@ -16,13 +16,41 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdio.h>
+#include <string.h>
+
 #include <QtCore/QCoreApplication>
 
 #include "server.h"
 
 int main(int argc, char *argv[])
 {
+  int i;
+  const char *record = 0, *replay = 0;
+  bool fast = false;
+
+  for(i = 1; i < argc; ++i)
+  {
+    if(strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+    {
+      record = argv[++i];
+    }
+    else if(strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+    {
+      replay = argv[++i];
+    }
+    else if(strcmp(argv[i], "--fast") == 0)
+    {
+      fast = true;
+    }
+    else
+    {
+      fprintf(stderr, "Usage: %s [--record file] [--replay file [--fast]]\n", argv[0]);
+      return 1;
+    }
+  }
+
   QCoreApplication app(argc, argv);
-  Server server(1001);
+  Server server(1001, record, replay, fast);
   return app.exec();
 }
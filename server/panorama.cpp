@@ -0,0 +1,146 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "panorama.h"
+
+//------------------------------------------------------------------------------
+
+Panorama::Panorama():
+  m_FreqMin(0), m_FreqMax(0),
+  m_Steps(0),
+  m_Clip(0), m_ClipH(0),
+  m_Bins(4096),
+  m_Pixels(0),
+  m_Center0(0.0), m_Step(0.0),
+  m_PixPerBin(0.0), m_BinPerPix(0.0),
+  m_Data(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+Panorama::~Panorama()
+{
+  delete [] m_Data;
+}
+
+//------------------------------------------------------------------------------
+
+void Panorama::configure(int32_t freqMin, int32_t freqMax, int32_t span, int32_t centerMin, int32_t pixels)
+{
+  int32_t usable, total;
+  double width;
+
+  if(freqMax < freqMin)
+  {
+    int32_t temp = freqMin;
+    freqMin = freqMax;
+    freqMax = temp;
+  }
+
+  // one eighth of the bins on each side is clipped
+  m_Clip = m_Bins / 8;
+  usable = m_Bins - 2 * m_Clip;
+  width = (double)span / m_Bins;
+  m_Step = usable * width;
+
+  // the FPGA FFT cannot be tuned below half of its span
+  m_Center0 = freqMin + m_Step / 2.0;
+  if(m_Center0 < centerMin) m_Center0 = centerMin;
+  m_FreqMin = (int32_t)floor(m_Center0 - m_Step / 2.0 + 0.5);
+
+  m_Steps = (int32_t)ceil((freqMax - m_FreqMin) / m_Step);
+  if(m_Steps < 1) m_Steps = 1;
+
+  // bins of the last sub-span that lie beyond the stop frequency
+  m_ClipH = (int32_t)floor((m_FreqMin + m_Steps * m_Step - freqMax) / width);
+  if(m_ClipH < 0) m_ClipH = 0;
+  if(m_ClipH > usable - 1) m_ClipH = usable - 1;
+
+  total = m_Steps * usable - m_ClipH;
+  m_FreqMax = (int32_t)floor(m_FreqMin + total * width + 0.5);
+
+  if(m_Pixels != pixels)
+  {
+    delete [] m_Data;
+    m_Data = new uint8_t[pixels];
+    m_Pixels = pixels;
+  }
+
+  m_PixPerBin = (double)m_Pixels / total;
+  m_BinPerPix = (double)total / m_Pixels;
+
+  reset();
+}
+
+//------------------------------------------------------------------------------
+
+void Panorama::reset()
+{
+  if(m_Data) memset(m_Data, 255, m_Pixels);
+}
+
+//------------------------------------------------------------------------------
+
+int32_t Panorama::center(int32_t step) const
+{
+  return (int32_t)floor(m_Center0 + step * m_Step + 0.5);
+}
+
+//------------------------------------------------------------------------------
+
+void Panorama::add(int32_t step, const uint8_t *bins)
+{
+  int32_t i, k, first, last, offset, pixel, stop;
+
+  if(!m_Data || step < 0 || step >= m_Steps) return;
+
+  first = m_Clip;
+  last = m_Bins - m_Clip;
+  if(step == m_Steps - 1) last -= m_ClipH;
+
+  // index of the first usable bin of this sub-span in the stitched spectrum
+  offset = step * (m_Bins - 2 * m_Clip) - m_Clip;
+
+  // the values are attenuations, so the strongest signal has the lowest value
+  if(m_PixPerBin <= 1.0)
+  {
+    for(i = first; i < last; ++i)
+    {
+      pixel = (int32_t)((offset + i) * m_PixPerBin);
+      if(bins[i] < m_Data[pixel]) m_Data[pixel] = bins[i];
+    }
+  }
+  else
+  {
+    pixel = (int32_t)ceil((offset + first) * m_PixPerBin);
+    stop = (int32_t)ceil((offset + last) * m_PixPerBin);
+    if(stop > m_Pixels) stop = m_Pixels;
+    for(; pixel < stop; ++pixel)
+    {
+      k = (int32_t)(pixel * m_BinPerPix) - offset;
+      if(k < first) k = first;
+      if(k > last - 1) k = last - 1;
+      m_Data[pixel] = bins[k];
+    }
+  }
+}
@@ -0,0 +1,58 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Panorama_h
+#define Panorama_h
+
+#include <stdint.h>
+
+// Stitches FPGA FFT frames taken at successive center frequencies into a
+// single panorama.  Each sub-span loses 'clip' bins on both sides, so that
+// the overlapping (and filter-attenuated) edges of neighbouring sub-spans
+// are used only once, and the last sub-span loses 'fscH' bins beyond the
+// requested stop frequency, as in the wdsp analyzer.
+
+class Panorama
+{
+public:
+  Panorama();
+  ~Panorama();
+
+  void configure(int32_t freqMin, int32_t freqMax, int32_t span, int32_t centerMin, int32_t pixels);
+  void reset();
+  void add(int32_t step, const uint8_t *bins);
+
+  int32_t steps() const { return m_Steps; }
+  int32_t center(int32_t step) const;
+  int32_t freqMin() const { return m_FreqMin; }
+  int32_t freqMax() const { return m_FreqMax; }
+  int32_t pixels() const { return m_Pixels; }
+  const uint8_t *data() const { return m_Data; }
+
+private:
+  int32_t m_FreqMin, m_FreqMax;
+  int32_t m_Steps;
+  int32_t m_Clip, m_ClipH;
+  int32_t m_Bins;
+  int32_t m_Pixels;
+  double m_Center0, m_Step;
+  double m_PixPerBin, m_BinPerPix;
+  uint8_t *m_Data;
+};
+
+#endif
@@ -17,69 +17,148 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <math.h>
+#include <string.h>
+#include <time.h>
 
 #include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QCoreApplication>
 #include <QtWebSockets/QWebSocketServer>
 #include <QtWebSockets/QWebSocket>
+#include <QtNetwork/QTcpSocket>
 
 #include <fftw3.h>
 
-#include <samplerate.h>
-
 extern "C"
 {
   #include "comm.h"
 }
 
 #include "server.h"
+#include "session.h"
+#include "panorama.h"
+#include "detector.h"
+#include "audiogroup.h"
+#include "waterfall.h"
+#include "iqstream.h"
 
 using namespace std;
 
+/* CPU time of the whole server, as a fraction of one core, above which the zoom frame rate is reduced */
+static const double ZoomBudget = 0.5;
+
+/* samples per DSP block of the channels, the sender hands the zoom analyzer one block per call */
+static const int32_t SizeDSP = 4096;
+
+/* largest zoom FFT, the analyzer keeps twice as many input samples */
+static const int32_t MaxSizeZoom = 16384;
+
+/* number of 32-bit data words that each command reads after the command and sequence words */
+static const int32_t CommandWords[] =
+{
+  0, 0, 0, 0, 0, 0, 0, 1, 1, 1,
+  1, 1, 1, 2, 2, 1, 1, 1, 1, 1,
+  1, 1, 3, 0, 2, 2, 1, 1, 5, 2,
+  2, 1, 1, 5, 3, 2, 1, 3, 2, 2,
+  2, 2, 4, 3, 5, 3
+};
+
 //------------------------------------------------------------------------------
 
-Server::Server(int16_t port, QObject *parent):
+Server::Server(int16_t port, const char *record, const char *replay, bool fast, QObject *parent):
   QObject(parent), m_Cfg(0), m_Sts(0),
-  m_BufferRX(0), m_BufferTX(0), m_BufferFFT(0),
-  m_LimitRX(256), m_InputOffsetRX(0),
+  m_BufferRX(0), m_BufferTX(0), m_BufferFFT(0), m_StagingFFT(0), m_StatusFFT(0),
+  m_LimitRX(256), m_InputOffsetRX(0), m_TimeRX(0), m_PositionRX(0), m_OverrunsRX(0),
   m_LimitTX(0), m_InputOffsetTX(0),
-  m_InputBufferRX(0), m_OutputBufferRX(0),
-  m_OutputBufferFFT(0),
-  m_CounterRX(0), m_PointerRX(0), m_FreqMin(25000),
-  m_StateRX(0), m_DataRX(0),
-  m_TimerRX(0), m_TimerFFT(0), m_TimerTX(0),
-  m_WebSocketServer(0), m_WebSocket(0)
+  m_InputBufferRX(0),
+  m_OutputBufferFFT(0), m_OutputBufferSweep(0),
+  m_OutputBufferTap(0), m_OutputBufferDetector(0),
+  m_OutputBufferCNG(0), m_OutputBufferMeter(0),
+  m_OutputBufferAck(0), m_BufferSend(0), m_CountRX(0),
+  m_FreqMin(25000), m_FreqFFT(610000),
+  m_FreqRX(621000), m_CenterRX(621000), m_OffsetRX(0), m_HybridRX(false),
+  m_RateRX(20000), m_RateDSP(20000), m_PendingRateRX(0), m_ResumeRX(false),
+  m_EnableFFT(false), m_EnableDetector(false), m_Detector(0),
+  m_Panorama(0), m_Sweep(false),
+  m_SweepFreqMin(0), m_SweepFreqMax(0), m_SweepPixels(0),
+  m_SweepStep(0), m_SweepSettle(0), m_SweepDwell(1), m_SweepInterval(0), m_StatusSweep(0),
+  m_EnableZoom(false), m_SizeZoom(4096), m_WindowZoom(1), m_PixelsZoom(1024), m_SpanZoom(20000),
+  m_RateZoom(10), m_LimitZoom(10), m_AverageZoom(0.0), m_BufferZoom(0),
+  m_CPUTimeZoom(0), m_WallTimeZoom(0), m_OutputBufferZoom(0),
+  m_DIV(0), m_BufferDIV(0), m_CounterDIV(0), m_AutoDIV(false), m_PowerDIV(0.0),
+  m_WFMD(0), m_RateNFM(20000), m_LoadWFM(0.0), m_PFB(0), m_TapPFB(-1),
+  m_TimerRX(0), m_TimerFFT(0), m_TimerTX(0), m_TimerReplay(0), m_TimerMeter(0), m_TimerZoom(0),
+  m_Record(0), m_Replay(0), m_ReplayClock(0), m_ReplayData(0),
+  m_ReplayType(0), m_ReplayTime(0), m_ReplayPending(false), m_ReplayFast(fast),
+  m_Hash(14695981039346656037ULL), m_Frames(0),
+  m_WebSocketServer(0)
 {
+  m_RotateDIV[0] = 1.0;
+  m_RotateDIV[1] = 0.0;
+  m_CorrelationDIV[0] = 0.0;
+  m_CorrelationDIV[1] = 0.0;
+
   int memFile;
   FILE *wisdomFile;
-  int32_t i, *pointerInt, error;
-  float *pointerFloat;
+  int32_t i, *pointerInt;
   int rc;
 
-  if((memFile = open("/dev/mem", O_RDWR)) < 0)
+  if(replay)
   {
-    perror("open");
-    qApp->quit();
+    m_Replay = new Session();
+    if(!m_Replay->openRead(replay))
+    {
+      qApp->quit();
+    }
+
+    /* replace the FPGA registers and buffers with plain memory */
+    m_Cfg = (uint32_t *)calloc(sysconf(_SC_PAGESIZE), 1);
+    m_Sts = (uint16_t *)calloc(sysconf(_SC_PAGESIZE), 1);
+    m_BufferRX = (int32_t *)calloc(sysconf(_SC_PAGESIZE), 1);
+    m_BufferTX = (int32_t *)calloc(sysconf(_SC_PAGESIZE), 1);
+    m_BufferFFT = (int32_t *)calloc(16*sysconf(_SC_PAGESIZE), 1);
+  }
+  else
+  {
+    if((memFile = open("/dev/mem", O_RDWR)) < 0)
+    {
+      perror("open");
+      qApp->quit();
+    }
+
+    m_Cfg = (uint32_t *)mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ|PROT_WRITE, MAP_SHARED, memFile, 0x40000000);
+    m_Sts = (uint16_t *)mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ|PROT_WRITE, MAP_SHARED, memFile, 0x40001000);
+    m_BufferRX = (int32_t *)mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ|PROT_WRITE, MAP_SHARED, memFile, 0x40002000);
+    m_BufferTX = (int32_t *)mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ|PROT_WRITE, MAP_SHARED, memFile, 0x40003000);
+    m_BufferFFT = (int32_t *)mmap(NULL, 16*sysconf(_SC_PAGESIZE), PROT_READ|PROT_WRITE, MAP_SHARED, memFile, 0x40010000);
   }
 
-  m_Cfg = (uint32_t *)mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ|PROT_WRITE, MAP_SHARED, memFile, 0x40000000);
-  m_Sts = (uint16_t *)mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ|PROT_WRITE, MAP_SHARED, memFile, 0x40001000);
-  m_BufferRX = (int32_t *)mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ|PROT_WRITE, MAP_SHARED, memFile, 0x40002000);
-  m_BufferTX = (int32_t *)mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ|PROT_WRITE, MAP_SHARED, memFile, 0x40003000);
-  m_BufferFFT = (int32_t *)mmap(NULL, 8*sysconf(_SC_PAGESIZE), PROT_READ|PROT_WRITE, MAP_SHARED, memFile, 0x40010000);
+  if(record)
+  {
+    m_Record = new Session();
+    if(!m_Record->openWrite(record))
+    {
+      delete m_Record;
+      m_Record = 0;
+    }
+  }
 
   /* enter reset mode */
   *(m_Cfg + 0) &= ~255;
   /* set default rate */
   *(m_Cfg + 1) = 1250;
+  *(m_Cfg + 5) = 6250;
   /* set default phase increment */
   *(m_Cfg + 2) = uint32_t(floor(621000/125.0e6*(1<<30)+0.5));
   *(m_Cfg + 3) = uint32_t(floor(610000/125.0e6*(1<<30)+0.5));
+  /* let the FPGA alternate between the two FFT banks */
+  *(m_Cfg + 0) |= 64;
 
   pointerInt = m_BufferTX;
   for(i = 0; i < 512; ++i) *(pointerInt++) = 0;
@@ -89,53 +168,82 @@ Server::Server(int16_t port, QObject *parent):
     fftwf_import_wisdom_from_file(wisdomFile);
     fclose(wisdomFile);
   }
-  OpenChannel(0, 256, 4096, 20000, 20000, 20000, 0, 0, 0.010, 0.025, 0.000, 0.010, 0);
-  OpenChannel(1, 256, 4096, 20000, 20000, 20000, 1, 0, 0.010, 0.025, 0.000, 0.010, 0);
+  /* block for output when replaying so that the output does not depend on the DSP thread timing */
+  OpenChannel(0, 256, SizeDSP, 20000, 20000, 20000, 0, 0, 0.010, 0.025, 0.000, 0.010, m_Replay ? 1 : 0);
+  OpenChannel(1, 256, SizeDSP, 20000, 20000, 20000, 1, 0, 0.010, 0.025, 0.000, 0.010, 0);
   if((wisdomFile = fopen("wdsp-fftw-wisdom.txt", "w")))
   {
     fftwf_export_wisdom_to_file(wisdomFile);
     fclose(wisdomFile);
   }
 
-  SetRXAShiftRun(0, 0);
-  SetRXAAMDRun(0, 1);
-  SetRXAMode(0, RXA_AM);
-  SetRXABandpassFreqs(0, -5000.0, 5000.0);
-  SetRXAAGCFixed(0, 30.0);
-  SetRXAAGCTop(0, 30.0);
-  SetRXAEMNRRun(0, 0);
+  setupRX();
+
+  /* zoom spectrum of the RX channel, fed by its spectrum sender */
+  XCreateAnalyzer(0, &rc, MaxSizeZoom, 1, 1, 0);
+  m_BufferZoom = new float[dMAX_PIXELS];
+  m_OutputBufferZoom = new QByteArray();
 
   m_InputBufferRX = new QByteArray();
-  m_InputBufferRX->resize(1590 * sizeof(float));
+  m_InputBufferRX->resize(1024 * sizeof(float));
+
+  m_StagingFFT = new int32_t[8192];
 
-  m_OutputBufferRX = new QByteArray();
-  m_OutputBufferRX->resize(2048 * sizeof(int16_t) + 4);
-  *(uint32_t *)(m_OutputBufferRX->constData() + 0) = 0;
+  m_BufferDIV = new float[1024];
 
   m_OutputBufferFFT = new QByteArray();
   m_OutputBufferFFT->resize(4096 * sizeof(uint8_t) + 4);
   *(uint32_t *)(m_OutputBufferFFT->constData() + 0) = 1;
 
-  m_PointerRX = (int16_t *)(m_OutputBufferRX->constData() + 4);
+  m_OutputBufferSweep = new QByteArray();
+  m_Panorama = new Panorama();
 
-  m_StateRX = src_new(SRC_SINC_FASTEST, 2, &error);
-  m_DataRX = new SRC_DATA;
+  m_OutputBufferTap = new QByteArray();
 
-  pointerFloat = (float *)(m_InputBufferRX->constData());
+  m_OutputBufferDetector = new QByteArray();
+  m_Detector = new Detector(4096);
 
-  m_DataRX->data_in = pointerFloat + 512;
-  m_DataRX->input_frames = 256;
+  m_OutputBufferCNG = new QByteArray();
+  m_OutputBufferCNG->resize(12);
+  *(uint32_t *)(m_OutputBufferCNG->constData() + 0) = 5;
+  *(uint32_t *)(m_OutputBufferCNG->constData() + 4) = 4;
 
-  m_DataRX->data_out = pointerFloat + 1024;
-  m_DataRX->output_frames = 283 ;
-  m_DataRX->src_ratio = 22050.0/20000.0;
-  m_DataRX->end_of_input = 0;
+  m_OutputBufferMeter = new QByteArray();
 
-  m_TimerRX = new QTimer(this);
-  connect(m_TimerRX, SIGNAL(timeout()), this, SLOT(on_TimerRX_timeout()));
 
+  m_OutputBufferAck = new QByteArray();
+  m_OutputBufferAck->resize(12);
+  *(uint32_t *)(m_OutputBufferAck->constData() + 0) = 9;
+
+  m_BufferSend = new QByteArray();
+
+  m_TimerRX = new QTimer(this);
+  m_TimerRX->setTimerType(Qt::PreciseTimer);
   m_TimerFFT = new QTimer(this);
+  m_TimerTX = new QTimer(this);
+  m_TimerMeter = new QTimer(this);
+  m_TimerZoom = new QTimer(this);
+
+  if(m_Replay)
+  {
+    /* the recorded samples drive the processing, the timers stay idle */
+    m_ReplayClock = new QElapsedTimer();
+    m_ReplayData = new QByteArray();
+    m_TimerReplay = new QTimer(this);
+    m_TimerReplay->setSingleShot(true);
+    connect(m_TimerReplay, SIGNAL(timeout()), this, SLOT(on_TimerReplay_timeout()));
+    /* the replayed commands act as a client without a connection */
+    joinAudioGroup(0, AudioGroup::DefaultRate, AudioGroup::DefaultChannels, AudioGroup::DefaultFormat, AudioGroup::DefaultFrames, false);
+    m_ReplayClock->start();
+    m_TimerReplay->start(0);
+    return;
+  }
+
+  connect(m_TimerRX, SIGNAL(timeout()), this, SLOT(on_TimerRX_timeout()));
   connect(m_TimerFFT, SIGNAL(timeout()), this, SLOT(on_TimerFFT_timeout()));
+  connect(m_TimerTX, SIGNAL(timeout()), this, SLOT(on_TimerTX_timeout()));
+  connect(m_TimerMeter, SIGNAL(timeout()), this, SLOT(on_TimerMeter_timeout()));
+  connect(m_TimerZoom, SIGNAL(timeout()), this, SLOT(on_TimerZoom_timeout()));
 
   m_WebSocketServer = new QWebSocketServer(QString("SDR"), QWebSocketServer::NonSecureMode, this);
   if(m_WebSocketServer->listen(QHostAddress::Any, port))
@@ -149,88 +257,786 @@ Server::Server(int16_t port, QObject *parent):
 
 Server::~Server()
 {
-  m_WebSocketServer->close();
-  if(m_WebSocket) delete m_WebSocket;
-  if(m_OutputBufferRX) delete m_OutputBufferRX;
+  int32_t i;
+
+  if(m_WebSocketServer) m_WebSocketServer->close();
+  for(i = 0; i < m_WebSockets.size(); ++i) delete m_WebSockets[i];
+  for(i = 0; i < m_AudioGroups.size(); ++i) delete m_AudioGroups[i];
+  qDeleteAll(m_Waterfalls);
+  qDeleteAll(m_StreamsIQ);
+  if(m_Record) delete m_Record;
+  if(m_Replay) delete m_Replay;
+  if(m_ReplayClock) delete m_ReplayClock;
+  if(m_ReplayData) delete m_ReplayData;
+  if(m_OutputBufferSweep) delete m_OutputBufferSweep;
+  if(m_Panorama) delete m_Panorama;
+  if(m_OutputBufferTap) delete m_OutputBufferTap;
+  if(m_PFB) destroy_pfb(m_PFB);
+  if(m_OutputBufferDetector) delete m_OutputBufferDetector;
+  if(m_Detector) delete m_Detector;
+  if(m_OutputBufferCNG) delete m_OutputBufferCNG;
+  if(m_OutputBufferMeter) delete m_OutputBufferMeter;
+  if(m_OutputBufferAck) delete m_OutputBufferAck;
+  if(m_BufferSend) delete m_BufferSend;
+  if(m_StagingFFT) delete [] m_StagingFFT;
+  if(m_DIV) destroy_div(m_DIV);
+  if(m_BufferDIV) delete [] m_BufferDIV;
+  if(m_WFMD) destroy_wfmd(m_WFMD);
+  SetRXASpectrum(0, 0, 0, 0, 0);
+  DestroyAnalyzer(0);
+  if(m_BufferZoom) delete [] m_BufferZoom;
+  if(m_OutputBufferZoom) delete m_OutputBufferZoom;
+}
+
+//------------------------------------------------------------------------------
+
+void Server::setupRX()
+{
+  SetRXAShiftRun(0, 0);
+  SetRXAAMDRun(0, 1);
+  SetRXAMode(0, RXA_AM);
+  SetRXABandpassFreqs(0, -5000.0, 5000.0);
+  SetRXAAGCFixed(0, 30.0);
+  SetRXAAGCTop(0, 30.0);
+  SetRXAEMNRRun(0, 0);
+}
+
+//------------------------------------------------------------------------------
+
+void Server::changeRateRX(int32_t rate)
+{
+  if(rate == m_RateRX && !m_PendingRateRX) return;
+  /* slew the audio down first, the rates change once the channel is flushed */
+  m_PendingRateRX = rate;
+  if(ch[0].state) m_ResumeRX = true;
+  SetChannelState(0, 0, 0);
+  updateRateRX();
+}
+
+//------------------------------------------------------------------------------
+
+void Server::updateRateRX()
+{
+  int32_t i;
+  QList<QByteArray> commands;
+  QMap<QWebSocket *, IQStream *>::iterator it;
+
+  if(!m_PendingRateRX) return;
+
+  /* processRX runs fexchange0 only while RX is on and some client gets audio, otherwise finish the flush here */
+  if(!m_TimerRX->isActive() || m_AudioGroups.isEmpty()) flushRX();
+
+  /* wait until the audio has been slewed down and the channel flushed */
+  if(ch[0].flushflag & 1) return;
+
+  m_RateRX = m_PendingRateRX;
+  m_PendingRateRX = 0;
+
+  *(m_Cfg + 0) &= ~128;
+  *(m_Cfg + 5) = 125000000 / m_RateRX;
+  *(m_Cfg + 0) |= 128;
+
+  /* decimate by a power of two inside wdsp, its buffer sizes must stay integers */
+  m_RateDSP = m_RateRX;
+  while(m_RateDSP > 31250) m_RateDSP /= 2;
+
+  /* the channel is rebuilt with the default settings, apply the client ones again */
+  SetAllRates(0, m_RateRX, m_RateDSP, m_RateDSP);
+  setupRX();
+  commands = m_CommandsRX;
+  m_CommandsRX.clear();
+  for(i = 0; i < commands.size(); ++i) processCommand(commands[i], 0);
+  tuneRX(m_FreqRX);
+
+  for(i = 0; i < m_AudioGroups.size(); ++i) m_AudioGroups[i]->setInputRate(m_RateDSP);
+  for(it = m_StreamsIQ.begin(); it != m_StreamsIQ.end(); ++it) it.value()->setRate(m_RateRX);
+  configureZoom();
+  if(m_PFB) *(int32_t *)(m_OutputBufferTap->constData() + 8) = m_RateRX * m_PFB->over / m_PFB->nc;
+
+  if(m_TimerRX->isActive()) startTimerRX();
+  if(m_ResumeRX) SetChannelState(0, 1, 0);
+  m_ResumeRX = false;
+}
+
+//------------------------------------------------------------------------------
+
+void Server::flushRX()
+{
+  int32_t error;
+  float *bufferFloat;
+
+  /*
+   * the slew down ends and the flush thread starts inside fexchange0,
+   * feed it silence until then and wait for the flush to complete
+   */
+  bufferFloat = (float *)(m_InputBufferRX->constData());
+  memset(bufferFloat, 0, 512 * sizeof(float));
+  while(!ch[0].state && (ch[0].exchange & 1)) fexchange0(0, bufferFloat, bufferFloat + 512, &error);
+  while(ch[0].flushflag & 1) usleep(1000);
+}
+
+//------------------------------------------------------------------------------
+
+void Server::startTimerRX()
+{
+  int32_t interval;
+
+  /* poll twice per half of the RX buffer, a half holds 128 samples of each ADC in diversity mode */
+  interval = (m_DIV ? 64000 : 128000) / m_RateRX;
+  /*
+   * at 250 kSPS a half lasts just over a millisecond, poll every millisecond
+   * and take what is ready, a poll that comes too late is counted as overrun
+   */
+  if(interval < 1) interval = 1;
+  m_TimeRX = 0;
+  m_TimerRX->start(interval);
+}
+
+//------------------------------------------------------------------------------
+
+void Server::tuneRX(int32_t freq)
+{
+  int32_t offset;
+
+  m_FreqRX = freq;
+
+  /* the RXA shift stage runs at the RX rate ahead of the decimation */
+  offset = m_OffsetRX;
+  if(offset > m_RateRX / 2) offset = m_RateRX / 2;
+
+  /* retune the FPGA only when the frequency leaves the range of the shift stage */
+  if(!m_HybridRX || abs(m_FreqRX - m_CenterRX) > offset)
+  {
+    m_CenterRX = m_FreqRX;
+    *(m_Cfg + 2) = uint32_t(floor(m_CenterRX/125.0e6*(1<<30)+0.5));
+  }
+
+  SetRXAShiftFreq(0, m_CenterRX - m_FreqRX);
+  SetRXAShiftRun(0, m_CenterRX != m_FreqRX);
 }
 
 //------------------------------------------------------------------------------
 
 void Server::on_TimerRX_timeout()
 {
-  int32_t i, offset, position, error;
-  int32_t *pointerInt;
-  float *bufferFloat, *pointerFloat;
+  int32_t offset, position, advance, turns;
+  int64_t now;
+  struct timespec ts;
 
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  now = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
   position = *(m_Sts + 0);
-  if((m_LimitRX > 0 && position > m_LimitRX) || (m_LimitRX == 0 && position < 256))
+
+  /*
+   * the FPGA was writing the pending half at the last poll, it overwrites
+   * unread samples once it has written the rest of that half and the whole
+   * other half, the position gives the advance modulo the ring and the time
+   * the number of whole turns, after an overrun continue with the half that
+   * is complete now
+   */
+  if(m_TimeRX > 0)
+  {
+    advance = (position - m_PositionRX) & 511;
+    turns = int32_t(((now - m_TimeRX) * m_RateRX * (m_DIV ? 2 : 1) / 1000000 - advance + 256) / 512);
+    if(turns > 0) advance += 512 * turns;
+    if(advance >= 512 - (m_PositionRX & 255))
+    {
+      ++m_OverrunsRX;
+      m_LimitRX = position < 256 ? 0 : 256;
+    }
+  }
+
+  /* at the higher rates more than one half may be ready */
+  while((m_LimitRX > 0 && position >= m_LimitRX) || (m_LimitRX == 0 && position < 256))
   {
     offset = m_LimitRX > 0 ? 0 : 512;
     m_LimitRX += 256;
     if(m_LimitRX == 512) m_LimitRX = 0;
-    pointerInt = m_BufferRX + offset;
-    bufferFloat = (float *)(m_InputBufferRX->constData());
+    if(m_Record) m_Record->write(Session::SamplesRX, m_BufferRX + offset, 512 * sizeof(int32_t));
+    processRX(m_BufferRX + offset);
+    position = *(m_Sts + 0);
+  }
+
+  /* the FPGA is writing the pending half now */
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  m_TimeRX = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  m_PositionRX = position;
+}
+
+//------------------------------------------------------------------------------
+
+void Server::processRX(int32_t *buffer)
+{
+  int32_t i, error;
+  int32_t *pointerInt;
+  float *bufferFloat, *pointerFloat, *pointerSecond;
+  AudioGroup *group;
+  struct timespec start, stop;
+
+  updateRateRX();
+
+  /* ADC samples received, per ADC in diversity mode */
+  m_CountRX += m_DIV ? 128 : 256;
+
+  pointerInt = buffer;
+  bufferFloat = (float *)(m_InputBufferRX->constData());
+  if(m_DIV)
+  {
+    /* both ADCs interleaved, combine them once 256 samples of each are in */
+    pointerFloat = m_BufferDIV + 2 * m_CounterDIV;
+    pointerSecond = pointerFloat + 512;
+    for(i = 0; i < 128; ++i)
+    {
+      *(pointerFloat++) = ((float) *(pointerInt++)) / 536870911.0;
+      *(pointerFloat++) = ((float) *(pointerInt++)) / 536870911.0;
+      *(pointerSecond++) = ((float) *(pointerInt++)) / 536870911.0;
+      *(pointerSecond++) = ((float) *(pointerInt++)) / 536870911.0;
+    }
+    m_CounterDIV += 128;
+    if(m_CounterDIV < 256) return;
+    m_CounterDIV = 0;
+    if(m_AutoDIV) updateDIV();
+    xdiv(m_DIV);
+  }
+  else
+  {
     pointerFloat = bufferFloat;
     for(i = 0; i < 512; ++i)
     {
       *(pointerFloat++) = ((float) *(pointerInt++)) / 536870911.0;
     }
+  }
+  if(!m_StreamsIQ.isEmpty()) sendIQ(bufferFloat);
+  if(m_PFB)
+  {
+    xpfb(m_PFB);
+    if(pfb_channel(m_PFB, m_TapPFB, (float *)(m_OutputBufferTap->constData() + 12))) sendFrame(m_OutputBufferTap);
+  }
+  /* no client listens, the offloading clients demodulate the IQ themselves */
+  if(m_AudioGroups.isEmpty()) return;
+  if(m_WFMD && m_RateRX == 250000)
+  {
+    /* broadcast FM bypasses RXA, keep track of the share of real time it takes */
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+    xwfmd(m_WFMD);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &stop);
+    m_LoadWFM = 0.99 * m_LoadWFM + 0.01 * ((stop.tv_sec - start.tv_sec) * 1.0e9 + (stop.tv_nsec - start.tv_nsec)) * m_RateRX / 256.0e9;
+  }
+  else
+  {
     fexchange0(0, bufferFloat, bufferFloat + 512, &error);
-    src_process(m_StateRX, m_DataRX) ;
-    pointerFloat = bufferFloat + 1024;
-    for(i = 0; i < m_DataRX->output_frames_gen * 2; ++i)
+  }
+  for(i = 0; i < m_AudioGroups.size(); ++i)
+  {
+    group = m_AudioGroups[i];
+    group->convert(bufferFloat + 512, 256 * m_RateDSP / m_RateRX);
+    while(group->fill()) sendAudio(group);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Server::updateDIV()
+{
+  int32_t i;
+  float re, im, power;
+  float *first, *second;
+
+  /*
+   * the weight of the second ADC that best matches it to the first one,
+   * the correlation of the first with the conjugate of the second over the
+   * power of the second, both averaged over about ten buffers
+   */
+  first = m_BufferDIV;
+  second = m_BufferDIV + 512;
+  re = 0.0;
+  im = 0.0;
+  power = 0.0;
+  for(i = 0; i < 256; ++i)
+  {
+    re += first[2 * i + 0] * second[2 * i + 0] + first[2 * i + 1] * second[2 * i + 1];
+    im += first[2 * i + 1] * second[2 * i + 0] - first[2 * i + 0] * second[2 * i + 1];
+    power += second[2 * i + 0] * second[2 * i + 0] + second[2 * i + 1] * second[2 * i + 1];
+  }
+
+  m_CorrelationDIV[0] += 0.1 * (re - m_CorrelationDIV[0]);
+  m_CorrelationDIV[1] += 0.1 * (im - m_CorrelationDIV[1]);
+  m_PowerDIV += 0.1 * (power - m_PowerDIV);
+
+  if(m_PowerDIV < 1.0e-20) return;
+
+  m_DIV->Irotate[1] = m_CorrelationDIV[0] / m_PowerDIV;
+  m_DIV->Qrotate[1] = m_CorrelationDIV[1] / m_PowerDIV;
+}
+
+//------------------------------------------------------------------------------
+
+void Server::sendIQ(float *buffer)
+{
+  QMap<QWebSocket *, IQStream *>::iterator it;
+  QByteArray *frame;
+
+  /* the IQ frames go only to the clients that subscribed to them */
+  for(it = m_StreamsIQ.begin(); it != m_StreamsIQ.end(); ++it)
+  {
+    it.value()->process(buffer);
+    frame = it.value()->frame();
+    if(m_Replay) hashFrame(frame);
+    if(!it.key()) continue;
+    prepareFrame(frame);
+    writeFrame(it.key());
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Server::sendAudio(AudioGroup *group)
+{
+  int32_t result;
+
+  /* the RXA squelch does not run while the wideband FM demodulator replaces RXA, so its state is stale */
+  result = group->gate(!m_WFMD && (GetRXAAMSQMuted(0) || GetRXAFMSQMuted(0)));
+
+  if(result & AudioGroup::Preroll) sendFrame(group->preroll(), group);
+  if(result & AudioGroup::Frame) sendFrame(group->frame(), group);
+  if(result & AudioGroup::Noise)
+  {
+    *(float *)(m_OutputBufferCNG->constData() + 8) = group->level();
+    sendFrame(m_OutputBufferCNG, group);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Server::joinAudioGroup(QWebSocket *webSocket, int32_t rate, int32_t channels, int32_t format, int32_t frames, bool dtx)
+{
+  int32_t i;
+  AudioGroup *group = 0;
+
+  leaveAudioGroup(webSocket);
+
+  for(i = 0; i < m_AudioGroups.size(); ++i)
+  {
+    if(m_AudioGroups[i]->matches(rate, channels, format, frames, dtx)) group = m_AudioGroups[i];
+  }
+
+  if(!group)
+  {
+    group = new AudioGroup(rate, channels, format, frames, dtx);
+    group->setInputRate(m_RateDSP);
+    m_AudioGroups.append(group);
+  }
+
+  group->clients().append(webSocket);
+}
+
+//------------------------------------------------------------------------------
+
+void Server::leaveAudioGroup(QWebSocket *webSocket)
+{
+  AudioGroup *group = findAudioGroup(webSocket);
+
+  if(!group) return;
+
+  group->clients().removeAll(webSocket);
+
+  /* nobody converts audio for an empty group */
+  if(!group->clients().isEmpty()) return;
+
+  m_AudioGroups.removeAll(group);
+  delete group;
+
+  /* a pending rate change cannot wait for processRX any more once no client gets audio */
+  if(m_AudioGroups.isEmpty()) updateRateRX();
+}
+
+//------------------------------------------------------------------------------
+
+AudioGroup *Server::findAudioGroup(QWebSocket *webSocket)
+{
+  int32_t i;
+
+  for(i = 0; i < m_AudioGroups.size(); ++i)
+  {
+    if(m_AudioGroups[i]->clients().contains(webSocket)) return m_AudioGroups[i];
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+void Server::on_TimerFFT_timeout()
+{
+  uint16_t status;
+
+  /*
+   * the FPGA writes one bank while the other one holds the last complete
+   * frame, bit 0 of the status is that bank and the other bits count the
+   * frames, a changed status after the copy means that the FPGA has
+   * switched over to the bank being copied, an unchanged status since the
+   * last copy means that this frame has already been processed
+   */
+  status = *(volatile uint16_t *)(m_Sts + 3);
+  if(status == m_StatusFFT) return;
+  memcpy(m_StagingFFT, m_BufferFFT + (status & 1) * 8192, 8192 * sizeof(int32_t));
+  if(*(volatile uint16_t *)(m_Sts + 3) != status) return;
+  m_StatusFFT = status;
+
+  /*
+   * drop the frames acquired while the sweep was retuning, that is the
+   * frame in progress when the new center was written and then the dwell,
+   * before recording so that a replay sees the same frames
+   */
+  if(m_Sweep)
+  {
+    if((((status >> 1) - (m_StatusSweep >> 1)) & 0x7fff) < 2) return;
+    if(m_SweepSettle > 0)
     {
-      *(m_PointerRX++) = int16_t(floor(*(pointerFloat++) * 32767.0 + 0.5));
-      ++m_CounterRX;
-      if(m_CounterRX == 2048)
-      {
-        m_CounterRX = 0;
-        m_PointerRX = (int16_t *)(m_OutputBufferRX->constData() + 4);
-        if(m_WebSocket) m_WebSocket->sendBinaryMessage(*m_OutputBufferRX);
-      }
+      --m_SweepSettle;
+      return;
     }
   }
+
+  if(m_Record) m_Record->write(Session::SamplesFFT, m_StagingFFT, 8192 * sizeof(int32_t));
+  processFFT(m_StagingFFT);
 }
 
 //------------------------------------------------------------------------------
 
-void Server::on_TimerFFT_timeout()
+void Server::processFFT(int32_t *buffer)
 {
-  int32_t i;
+  int32_t i, count;
   float re, im;
   uint8_t *pointerInt;
 
-  *(m_Cfg + 0) &= ~32;
-
   pointerInt = (uint8_t *)(m_OutputBufferFFT->constData() + 4);
   for(i = 2048; i < 4096; ++i)
   {
-    re = float(*(m_BufferFFT + 2*i + 0))/2147483647.0;
-    im = float(*(m_BufferFFT + 2*i + 1))/2147483647.0;
+    re = float(*(buffer + 2*i + 0))/2147483647.0;
+    im = float(*(buffer + 2*i + 1))/2147483647.0;
     *(pointerInt++) = uint8_t(floor(-20.0*log10(hypot(re, im)/2048.0) + 0.5));
   }
   for(i = 0; i < 2048; ++i)
   {
-    re = float(*(m_BufferFFT + 2*i + 0))/2147483647.0;
-    im = float(*(m_BufferFFT + 2*i + 1))/2147483647.0;
+    re = float(*(buffer + 2*i + 0))/2147483647.0;
+    im = float(*(buffer + 2*i + 1))/2147483647.0;
     *(pointerInt++) = uint8_t(floor(-20.0*log10(hypot(re, im)/2048.0) + 0.5));
   }
 
-  if(m_WebSocket) m_WebSocket->sendBinaryMessage(*m_OutputBufferFFT);
+  if(!m_Sweep)
+  {
+    if(m_EnableFFT) sendFrame(m_OutputBufferFFT);
+    if(!m_Waterfalls.isEmpty()) sendWaterfalls();
+    if(m_EnableDetector)
+    {
+      m_Detector->process((uint8_t *)(m_OutputBufferFFT->constData() + 4));
+      count = m_Detector->count();
+      m_OutputBufferDetector->resize(count * sizeof(Detector::Detection) + 20);
+      *(uint32_t *)(m_OutputBufferDetector->constData() + 0) = 4;
+      *(uint32_t *)(m_OutputBufferDetector->constData() + 4) = m_Detector->frame();
+      *(int32_t *)(m_OutputBufferDetector->constData() + 8) = m_FreqFFT;
+      *(int32_t *)(m_OutputBufferDetector->constData() + 12) = 2 * m_FreqMin;
+      *(int32_t *)(m_OutputBufferDetector->constData() + 16) = count;
+      memcpy((char *)m_OutputBufferDetector->constData() + 20, m_Detector->detections(), count * sizeof(Detector::Detection));
+      sendFrame(m_OutputBufferDetector);
+    }
+    return;
+  }
+
+  m_Panorama->add(m_SweepStep, (uint8_t *)(m_OutputBufferFFT->constData() + 4));
+  if(++m_SweepStep == m_Panorama->steps())
+  {
+    memcpy((char *)m_OutputBufferSweep->constData() + 12, m_Panorama->data(), m_Panorama->pixels());
+    sendFrame(m_OutputBufferSweep);
+    m_Panorama->reset();
+    m_SweepStep = 0;
+  }
+
+  *(m_Cfg + 3) = uint32_t(floor(m_Panorama->center(m_SweepStep)/125.0e6*(1<<30)+0.5));
+  m_StatusSweep = *(volatile uint16_t *)(m_Sts + 3);
+  m_SweepSettle = m_SweepDwell;
+}
+
+//------------------------------------------------------------------------------
+
+void Server::startSweep()
+{
+  int32_t interval;
+
+  m_Panorama->configure(m_SweepFreqMin, m_SweepFreqMax, 2 * m_FreqMin, m_FreqMin, m_SweepPixels);
+
+  m_OutputBufferSweep->resize(m_Panorama->pixels() + 12);
+  *(uint32_t *)(m_OutputBufferSweep->constData() + 0) = 2;
+  *(int32_t *)(m_OutputBufferSweep->constData() + 4) = m_Panorama->freqMin();
+  *(int32_t *)(m_OutputBufferSweep->constData() + 8) = m_Panorama->freqMax();
+
+  m_Sweep = true;
+  m_SweepStep = 0;
+  m_SweepSettle = m_SweepDwell;
+  *(m_Cfg + 3) = uint32_t(floor(m_Panorama->center(0)/125.0e6*(1<<30)+0.5));
+  m_StatusSweep = *(volatile uint16_t *)(m_Sts + 3);
+
+  /* poll just after a full frame of 4096 samples at the FFT rate */
+  interval = m_SweepInterval;
+  if(interval == 0) interval = 4096 * 1000 / (2 * m_FreqMin) + 1;
+
+  *(m_Cfg + 0) |= 61;
+  m_TimerFFT->start(interval);
+}
+
+//------------------------------------------------------------------------------
+
+void Server::stopSweep()
+{
+  if(!m_Sweep) return;
+
+  m_Sweep = false;
+  *(m_Cfg + 3) = uint32_t(floor(m_FreqFFT/125.0e6*(1<<30)+0.5));
+
+  /* drop the sweep interval, updateTimerFFT restarts the timer at the normal rate */
+  m_TimerFFT->stop();
+  updateTimerFFT();
+}
+
+//------------------------------------------------------------------------------
+
+void Server::updateTimerFFT()
+{
+  if(m_Sweep) return;
+
+  if(m_EnableFFT || m_EnableDetector || !m_Waterfalls.isEmpty())
+  {
+    *(m_Cfg + 0) |= 61;
+    if(!m_TimerFFT->isActive()) m_TimerFFT->start(100);
+  }
+  else
+  {
+    m_TimerFFT->stop();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Server::sendWaterfalls()
+{
+  QMap<QWebSocket *, Waterfall *>::iterator it;
+  QByteArray *frame;
+
+  for(it = m_Waterfalls.begin(); it != m_Waterfalls.end(); ++it)
+  {
+    if(!it.value()->add((uint8_t *)(m_OutputBufferFFT->constData() + 4))) continue;
+    frame = it.value()->frame();
+    *(int32_t *)(frame->constData() + 4) = m_FreqFFT;
+    *(int32_t *)(frame->constData() + 8) = 2 * m_FreqMin;
+    if(m_Replay) hashFrame(frame);
+    if(!it.key()) continue;
+    prepareFrame(frame);
+    writeFrame(it.key());
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Server::configureZoom()
+{
+  int32_t overlap, clip, writeahead;
+  int flip = 0;
+
+  SetRXASpectrum(0, 0, 0, 0, 0);
+  m_TimerZoom->stop();
+
+  if(!m_EnableZoom) return;
+
+  /* one FFT per frame, overlapped when the frames come faster than the samples fill one */
+  overlap = m_SizeZoom - m_RateDSP / m_RateZoom;
+  if(overlap < 0) overlap = 0;
+
+  /*
+   * the sender delivers the channel IQ at the DSP rate ahead of the RX
+   * bandpass, so the whole DSP bandwidth is shown, clip the bins outside
+   * of the span
+   */
+  clip = 0;
+  if(m_SpanZoom < m_RateDSP) clip = int32_t((int64_t)(m_RateDSP - m_SpanZoom) * m_SizeZoom / m_RateDSP / 2);
+
+  /*
+   * let the samples run at most one tenth of a second ahead of the FFT,
+   * the block written after the skip must still fit into the input ring
+   */
+  writeahead = m_SizeZoom + m_RateDSP / 10;
+  if(writeahead > 2 * m_SizeZoom) writeahead = 2 * m_SizeZoom;
+  if(writeahead > 2 * MaxSizeZoom - SizeDSP) writeahead = 2 * MaxSizeZoom - SizeDSP;
+
+  SetAnalyzer(0, 1, 1, &flip, m_SizeZoom, SizeDSP, m_WindowZoom, 14.0, overlap, 0, clip, clip,
+    m_PixelsZoom, 1, m_AverageZoom > 0.0 ? 2 : 0, 1, m_AverageZoom, 0, 0.0, 0.0, writeahead);
+
+  m_OutputBufferZoom->resize(m_PixelsZoom + 12);
+  *(uint32_t *)(m_OutputBufferZoom->constData() + 0) = 10;
+  *(int32_t *)(m_OutputBufferZoom->constData() + 8) = int32_t((int64_t)(m_SizeZoom - 2 * clip) * m_RateDSP / m_SizeZoom);
+
+  SetRXASpectrum(0, 1, 0, 0, 0);
+  m_WallTimeZoom = 0;
+  m_TimerZoom->start(1000 / m_RateZoom);
+}
+
+//------------------------------------------------------------------------------
+
+void Server::hashFrame(QByteArray *frame)
+{
+  int32_t i, size;
+  const uint8_t *pointer;
+
+  /* FNV-1a hash over all output frames */
+  size = frame->size();
+  pointer = (const uint8_t *)frame->constData();
+  for(i = 0; i < size; ++i)
+  {
+    m_Hash ^= *(pointer++);
+    m_Hash *= 1099511628211ULL;
+  }
+  ++m_Frames;
+}
+
+//------------------------------------------------------------------------------
+
+void Server::prepareFrame(QByteArray *frame)
+{
+  int32_t size;
+  struct timespec now;
+
+  /*
+   * every frame goes out with a header of type, sequence number of the
+   * client, ADC sample counter and wall clock time in microseconds, the
+   * rest of the frame follows as it is
+   */
+  size = frame->size();
+  clock_gettime(CLOCK_REALTIME, &now);
+  m_BufferSend->resize(size + 20);
+  *(uint32_t *)(m_BufferSend->constData() + 0) = *(uint32_t *)(frame->constData() + 0);
+  *(uint64_t *)(m_BufferSend->constData() + 8) = m_CountRX;
+  *(int64_t *)(m_BufferSend->constData() + 16) = int64_t(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+  memcpy((char *)m_BufferSend->constData() + 24, frame->constData() + 4, size - 4);
+}
+
+//------------------------------------------------------------------------------
+
+void Server::writeFrame(QWebSocket *webSocket)
+{
+  *(uint32_t *)(m_BufferSend->constData() + 4) = m_Sequence[webSocket]++;
+  webSocket->sendBinaryMessage(*m_BufferSend);
+}
+
+//------------------------------------------------------------------------------
+
+void Server::sendFrame(QByteArray *frame)
+{
+  int32_t i;
+
+  if(m_Replay) hashFrame(frame);
+
+  if(m_WebSockets.isEmpty()) return;
+
+  prepareFrame(frame);
+  for(i = 0; i < m_WebSockets.size(); ++i)
+  {
+    writeFrame(m_WebSockets[i]);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Server::sendFrame(QByteArray *frame, AudioGroup *group)
+{
+  int32_t i;
+  QWebSocket *webSocket;
+
+  if(m_Replay) hashFrame(frame);
+
+  if(m_WebSockets.isEmpty()) return;
 
-  *(m_Cfg + 0) |= 32;
+  prepareFrame(frame);
+  for(i = 0; i < group->clients().size(); ++i)
+  {
+    webSocket = group->clients()[i];
+    if(webSocket) writeFrame(webSocket);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Server::on_TimerReplay_timeout()
+{
+  int64_t delay;
+
+  while(true)
+  {
+    if(!m_ReplayPending)
+    {
+      if(!m_Replay->read(&m_ReplayType, &m_ReplayTime, m_ReplayData))
+      {
+        printf("replay: %llu frames, hash %016llx, %lld ms\n",
+          (unsigned long long)m_Frames, (unsigned long long)m_Hash, (long long)m_ReplayClock->elapsed());
+        qApp->quit();
+        return;
+      }
+      m_ReplayPending = true;
+    }
+
+    if(!m_ReplayFast)
+    {
+      delay = m_ReplayTime / 1000 - m_ReplayClock->elapsed();
+      if(delay > 0)
+      {
+        m_TimerReplay->start(delay);
+        return;
+      }
+    }
+
+    m_ReplayPending = false;
+
+    switch(m_ReplayType)
+    {
+      case Session::Command:
+        /* the commands of the first session version have no sequence number */
+        if(m_Replay->version() < 2 && m_ReplayData->size() >= 4) m_ReplayData->insert(4, QByteArray(4, 0));
+        processCommand(*m_ReplayData, 0);
+        break;
+      case Session::SamplesRX:
+        if(m_ReplayData->size() == 512 * sizeof(int32_t)) processRX((int32_t *)m_ReplayData->data());
+        break;
+      case Session::SamplesFFT:
+        if(m_ReplayData->size() == 8192 * sizeof(int32_t)) processFFT((int32_t *)m_ReplayData->data());
+        break;
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
 
 void Server::on_WebSocket_binaryMessageReceived(QByteArray message)
+{
+  QWebSocket *webSocket = qobject_cast<QWebSocket *>(sender());
+
+  if(m_Record) m_Record->write(Session::Command, message.constData(), message.size());
+  processCommand(message, webSocket);
+}
+
+//------------------------------------------------------------------------------
+
+void Server::processCommand(QByteArray &message, QWebSocket *webSocket)
 {
   int32_t i, size;
   int32_t command;
+  uint32_t sequence;
   int32_t *dataInt;
   float *dataFloat;
   int32_t *pointerInt;
   float *bufferReal, *bufferComplex;
+  AudioGroup *group;
+  QTcpSocket *socket;
+  float *pointerDIV[2];
+  float *bufferFloat;
   int flp = 1;
 /*
   size = txa[0].size;
@@ -243,9 +1049,25 @@ void Server::on_WebSocket_binaryMessageReceived(QByteArray message)
     *(bufferComplex++) = *(bufferReal++);
   }
 */
+  /* reject the messages that are too short for the command and its data */
+  if(message.size() < 8) return;
   command = *(int32_t *)(message.constData() + 0);
-  dataInt = (int32_t *)(message.constData() + 4);
-  dataFloat = (float *)(message.constData() + 4);
+  if(command >= 0 && command < int32_t(sizeof(CommandWords) / sizeof(CommandWords[0])) &&
+    message.size() < 8 + 4 * CommandWords[command]) return;
+
+  sequence = *(uint32_t *)(message.constData() + 4);
+  dataInt = (int32_t *)(message.constData() + 8);
+  dataFloat = (float *)(message.constData() + 8);
+
+  /* keep the last RXA settings, they are applied again when the channel is rebuilt */
+  if(command == 11 || command == 13 || (command >= 15 && command <= 21) || command == 29 || command == 30 || command == 40 || command == 41)
+  {
+    for(i = 0; i < m_CommandsRX.size(); ++i)
+    {
+      if(*(int32_t *)(m_CommandsRX[i].constData() + 0) == command) m_CommandsRX.removeAt(i--);
+    }
+    m_CommandsRX.append(message);
+  }
 
   switch(command)
   {
@@ -255,21 +1077,27 @@ void Server::on_WebSocket_binaryMessageReceived(QByteArray message)
     case 1:
       // start RX
       *(m_Cfg + 0) |= 3;
-      SetChannelState(0, 1, 0);
-      m_TimerRX->start(6);
+      /* the channel is resumed once a pending rate change has flushed it */
+      if(m_PendingRateRX) m_ResumeRX = true;
+      else SetChannelState(0, 1, 0);
+      startTimerRX();
       break;
     case 2:
       // stop RX
       m_TimerRX->stop();
+      /* the client subscribes to IQ again when it starts RX */
+      if(m_StreamsIQ.contains(webSocket)) delete m_StreamsIQ.take(webSocket);
+      updateRateRX();
       break;
     case 3:
       // start FFT
-      *(m_Cfg + 0) |= 61;
-      m_TimerFFT->start(100);
+      m_EnableFFT = true;
+      updateTimerFFT();
       break;
     case 4:
       // stop FFT
-      m_TimerFFT->stop();
+      m_EnableFFT = false;
+      updateTimerFFT();
       break;
     case 5:
       // start TX
@@ -309,15 +1137,18 @@ void Server::on_WebSocket_binaryMessageReceived(QByteArray message)
           *(m_Cfg + 0) |= 8;
           break;
       }
+      if(m_Sweep) startSweep();
       break;
     case 8:
       // set RX frequency
       if(dataInt[0] < 10000 || dataInt[0] > 50000000) break;
-      *(m_Cfg + 2) = uint32_t(floor(dataInt[0]/125.0e6*(1<<30)+0.5));
+      tuneRX(dataInt[0]);
       break;
     case 9:
       // set FFT frequency
       if(dataInt[0] < m_FreqMin || dataInt[0] > 50000000) break;
+      m_FreqFFT = dataInt[0];
+      if(m_Sweep) break;
       *(m_Cfg + 3) = uint32_t(floor(dataInt[0]/125.0e6*(1<<30)+0.5));
       break;
     case 10:
@@ -381,7 +1212,267 @@ void Server::on_WebSocket_binaryMessageReceived(QByteArray message)
       if(dataInt[0] < 0 || dataInt[0] > 100) break;
       SetRXAAGCHangThreshold(0, dataInt[0]);
       break;
+    case 22:
+      // start sweep
+      if(dataInt[0] < 0 || dataInt[0] > 50000000) break;
+      if(dataInt[1] < 0 || dataInt[1] > 50000000) break;
+      if(dataInt[2] < 16 || dataInt[2] > 8192) break;
+      m_SweepFreqMin = dataInt[0];
+      m_SweepFreqMax = dataInt[1];
+      m_SweepPixels = dataInt[2];
+      startSweep();
+      break;
+    case 23:
+      // stop sweep
+      stopSweep();
+      break;
+    case 24:
+      // set sweep settle frames and interval
+      if(dataInt[0] < 0 || dataInt[0] > 10) break;
+      if(dataInt[1] < 0 || dataInt[1] > 1000) break;
+      m_SweepDwell = dataInt[0];
+      m_SweepInterval = dataInt[1];
+      if(m_Sweep) startSweep();
+      break;
+    case 25:
+      // set channelizer, number of channels (0 = off) and oversampling
+      if(dataInt[0] != 0 && (dataInt[0] < 2 || dataInt[0] > 256 || (dataInt[0] & (dataInt[0] - 1)))) break;
+      if(dataInt[0] != 0 && (dataInt[1] < 1 || dataInt[1] > 2)) break;
+      if(m_PFB) destroy_pfb(m_PFB);
+      m_PFB = 0;
+      m_TapPFB = -1;
+      if(dataInt[0] == 0) break;
+      m_PFB = create_pfb(1, 256, (float *)(m_InputBufferRX->constData()), dataInt[0], dataInt[1], 8);
+      m_OutputBufferTap->resize(m_PFB->nout * 2 * sizeof(float) + 12);
+      *(uint32_t *)(m_OutputBufferTap->constData() + 0) = 3;
+      *(int32_t *)(m_OutputBufferTap->constData() + 8) = m_RateRX * dataInt[1] / dataInt[0];
+      break;
+    case 26:
+      // set channelizer tap (-1 = off)
+      if(!m_PFB || dataInt[0] < -1 || dataInt[0] >= m_PFB->nc) break;
+      m_TapPFB = dataInt[0];
+      *(int32_t *)(m_OutputBufferTap->constData() + 4) = m_TapPFB;
+      break;
+    case 27:
+      // subscribe to detections
+      m_EnableDetector = dataInt[0] != 0;
+      updateTimerFFT();
+      break;
+    case 28:
+      // set detector method, threshold, guard and reference bins, hold frames
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataInt[1] < 1 || dataInt[1] > 100) break;
+      if(dataInt[2] < 0 || dataInt[2] > 64) break;
+      if(dataInt[3] < 1 || dataInt[3] > 256) break;
+      if(dataInt[4] < 0 || dataInt[4] > 1000) break;
+      m_Detector->configure(dataInt[0], dataInt[1], dataInt[2], dataInt[3], dataInt[4]);
+      break;
+    case 29:
+      // set RX AM squelch run and threshold
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataFloat[1] < -160.0 || dataFloat[1] > 0.0) break;
+      SetRXAAMSQThreshold(0, dataFloat[1]);
+      SetRXAAMSQRun(0, dataInt[0]);
+      break;
+    case 30:
+      // set RX FM squelch run and threshold
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataFloat[1] < 0.0 || dataFloat[1] > 1.0) break;
+      SetRXAFMSQThreshold(0, dataFloat[1]);
+      SetRXAFMSQRun(0, dataInt[0]);
+      break;
+    case 31:
+      // set discontinuous audio transmission of this client
+      group = findAudioGroup(webSocket);
+      if(!group) break;
+      joinAudioGroup(webSocket, group->rate(), group->channels(), group->format(), group->frames(), dataInt[0] != 0);
+      break;
+    case 32:
+      // set meter rate in frames per second (0 = off)
+      if(dataInt[0] < 0 || dataInt[0] > 50) break;
+      if(dataInt[0] == 0) m_TimerMeter->stop();
+      else m_TimerMeter->start(1000 / dataInt[0]);
+      break;
+    case 33:
+      // subscribe to IQ: enable, mantissa bits, decimation, frequency shift, IQ only
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataInt[1] != 8 && dataInt[1] != 10 && dataInt[1] != 12) break;
+      if(dataInt[2] != 1 && dataInt[2] != 2 && dataInt[2] != 4 && dataInt[2] != 8) break;
+      if(dataFloat[3] < -10.0e3 || dataFloat[3] > 10.0e3) break;
+      if(m_StreamsIQ.contains(webSocket)) delete m_StreamsIQ.take(webSocket);
+      if(dataInt[0]) m_StreamsIQ[webSocket] = new IQStream(dataInt[1], dataInt[2], dataFloat[3], m_RateRX);
+      /* an offloading client leaves the audio groups, the others return to the default one */
+      if(dataInt[0] && dataInt[4]) leaveAudioGroup(webSocket);
+      else if(!findAudioGroup(webSocket)) joinAudioGroup(webSocket, AudioGroup::DefaultRate, AudioGroup::DefaultChannels, AudioGroup::DefaultFormat, AudioGroup::DefaultFrames, false);
+      break;
+    case 34:
+      // set audio rate, number of channels and sample format of this client
+      if(dataInt[0] < 8000 || dataInt[0] > 48000) break;
+      if(dataInt[1] < 1 || dataInt[1] > 2) break;
+      if(dataInt[2] < 0 || dataInt[2] > 2) break;
+      group = findAudioGroup(webSocket);
+      joinAudioGroup(webSocket, dataInt[0], dataInt[1], dataInt[2], group ? group->frames() : AudioGroup::DefaultFrames, group ? group->dtx() : false);
+      break;
+    case 35:
+      // set audio frame size of this client in samples and low delay mode
+      if(dataInt[0] < 128 || dataInt[0] > 1024 || (dataInt[0] & (dataInt[0] - 1))) break;
+      if(dataInt[1] < 0 || dataInt[1] > 1) break;
+      /* disable the Nagle algorithm, so that small frames leave at once */
+      socket = webSocket ? webSocket->findChild<QTcpSocket *>() : 0;
+      if(socket) socket->setSocketOption(QAbstractSocket::LowDelayOption, dataInt[1]);
+      group = findAudioGroup(webSocket);
+      if(!group) break;
+      joinAudioGroup(webSocket, group->rate(), group->channels(), group->format(), dataInt[0], group->dtx());
+      break;
+    case 36:
+      // set RX rate
+      if(dataInt[0] != 20000 && dataInt[0] != 25000 && dataInt[0] != 50000 && dataInt[0] != 100000 && dataInt[0] != 125000) break;
+      /* broadcast FM needs its own rate, the new one applies when it is turned off */
+      if(m_WFMD)
+      {
+        m_RateNFM = dataInt[0];
+        break;
+      }
+      changeRateRX(dataInt[0]);
+      break;
+    case 37:
+      // set diversity run, output (0 = first ADC, 1 = second ADC, 2 = combined) and automatic weight
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataInt[1] < 0 || dataInt[1] > 2) break;
+      if(dataInt[2] < 0 || dataInt[2] > 1) break;
+      if(dataInt[0] && m_WFMD) break;
+      if(m_DIV) destroy_div(m_DIV);
+      m_DIV = 0;
+      m_CounterDIV = 0;
+      m_AutoDIV = dataInt[2];
+      m_CorrelationDIV[0] = 0.0;
+      m_CorrelationDIV[1] = 0.0;
+      m_PowerDIV = 0.0;
+      /* the FPGA interleaves the samples of both ADCs in the RX buffer */
+      if(dataInt[0])
+      {
+        *(m_Cfg + 0) |= 256;
+        pointerDIV[0] = m_BufferDIV;
+        pointerDIV[1] = m_BufferDIV + 512;
+        m_DIV = create_div(1, 2, 256, pointerDIV, (float *)(m_InputBufferRX->constData()));
+        m_DIV->output = dataInt[1];
+        m_DIV->Irotate[0] = 1.0;
+        m_DIV->Qrotate[0] = 0.0;
+        m_DIV->Irotate[1] = m_RotateDIV[0];
+        m_DIV->Qrotate[1] = m_RotateDIV[1];
+      }
+      else
+      {
+        *(m_Cfg + 0) &= ~256;
+      }
+      if(m_TimerRX->isActive()) startTimerRX();
+      break;
+    case 38:
+      // set diversity gain in dB and phase in degrees of the second ADC
+      if(dataFloat[0] < -40.0 || dataFloat[0] > 40.0) break;
+      if(dataFloat[1] < -180.0 || dataFloat[1] > 180.0) break;
+      m_RotateDIV[0] = pow(10.0, dataFloat[0] / 20.0) * cos(dataFloat[1] * M_PI / 180.0);
+      m_RotateDIV[1] = pow(10.0, dataFloat[0] / 20.0) * sin(dataFloat[1] * M_PI / 180.0);
+      if(!m_DIV || m_AutoDIV) break;
+      m_DIV->Irotate[1] = m_RotateDIV[0];
+      m_DIV->Qrotate[1] = m_RotateDIV[1];
+      break;
+    case 39:
+      // set hybrid tuning run and the largest offset in Hz covered by the RXA shift stage
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataInt[1] < 0 || dataInt[1] > 62500) break;
+      m_HybridRX = dataInt[0];
+      m_OffsetRX = dataInt[1];
+      tuneRX(m_FreqRX);
+      break;
+    case 40:
+      // set RX noise blanker run and threshold relative to the average magnitude
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataFloat[1] < 1.0 || dataFloat[1] > 100.0) break;
+      SetRXAANBThreshold(0, dataFloat[1]);
+      SetRXAANBRun(0, dataInt[0]);
+      break;
+    case 41:
+      // set RX noise blanker hang and advance times in ms
+      if(dataFloat[0] < 0.0 || dataFloat[0] > 10.0) break;
+      if(dataFloat[1] < 0.0 || dataFloat[1] > 2.0) break;
+      SetRXAANBHangtime(0, dataFloat[0] * 1.0e-3);
+      SetRXAANBAdvtime(0, dataFloat[1] * 1.0e-3);
+      break;
+    case 42:
+      // set zoom spectrum run, FFT size, window and number of pixels
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataInt[1] < 1024 || dataInt[1] > MaxSizeZoom || (dataInt[1] & (dataInt[1] - 1))) break;
+      if(dataInt[2] < 0 || dataInt[2] > 6) break;
+      if(dataInt[3] < 64 || dataInt[3] > dMAX_PIXELS) break;
+      m_EnableZoom = dataInt[0];
+      m_SizeZoom = dataInt[1];
+      m_WindowZoom = dataInt[2];
+      m_PixelsZoom = dataInt[3];
+      configureZoom();
+      break;
+    case 43:
+      // set zoom spectrum span in Hz, frame rate in frames per second and averaging back multiplier
+      if(dataInt[0] < 100 || dataInt[0] > 125000) break;
+      if(dataInt[1] < 1 || dataInt[1] > 50) break;
+      if(dataFloat[2] < 0.0 || dataFloat[2] > 0.99) break;
+      m_SpanZoom = dataInt[0];
+      m_RateZoom = m_LimitZoom = dataInt[1];
+      m_AverageZoom = dataFloat[2];
+      configureZoom();
+      break;
+    case 44:
+      // subscribe to waterfall tiles: enable, width in pixels, rows per tile, strongest and weakest attenuation in dB
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataInt[1] < 64 || dataInt[1] > 4096) break;
+      if(dataInt[2] < 1 || dataInt[2] > 64) break;
+      if(dataInt[3] < 0 || dataInt[4] > 255 || dataInt[3] >= dataInt[4]) break;
+      if(m_Waterfalls.contains(webSocket))
+      {
+        if(dataInt[0] && m_Waterfalls[webSocket]->matches(dataInt[1], dataInt[2], dataInt[3], dataInt[4])) break;
+        delete m_Waterfalls.take(webSocket);
+      }
+      if(dataInt[0]) m_Waterfalls[webSocket] = new Waterfall(dataInt[1], dataInt[2], dataInt[3], dataInt[4]);
+      updateTimerFFT();
+      break;
+    case 45:
+      // set wideband FM run, de-emphasis time constant in us (0 = off) and stereo decoding
+      if(dataInt[0] < 0 || dataInt[0] > 1) break;
+      if(dataInt[1] != 0 && dataInt[1] != 50 && dataInt[1] != 75) break;
+      if(dataInt[2] < 0 || dataInt[2] > 1) break;
+      if(m_DIV) break;
+      /*
+       * the rate change completes at once while RX is stopped or nobody gets
+       * audio, so that a following start RX finds the channel flushed
+       */
+      if(dataInt[0] && !m_WFMD)
+      {
+        /* demodulate 256 samples at 250 kSPS into 32 stereo samples at 31250 Hz in place of RXA */
+        bufferFloat = (float *)(m_InputBufferRX->constData());
+        m_WFMD = create_wfmd(1, 256, bufferFloat, bufferFloat + 512, 250000, 75000.0, 0.0, 1);
+        m_LoadWFM = 0.0;
+        m_OverrunsRX = 0;
+        m_RateNFM = m_PendingRateRX ? m_PendingRateRX : m_RateRX;
+        changeRateRX(250000);
+      }
+      else if(!dataInt[0] && m_WFMD)
+      {
+        destroy_wfmd(m_WFMD);
+        m_WFMD = 0;
+        changeRateRX(m_RateNFM);
+      }
+      if(!m_WFMD) break;
+      pSetWFMDDeemphasis(m_WFMD, dataInt[1] * 1.0e-6);
+      pSetWFMDStereo(m_WFMD, dataInt[2]);
+      break;
   }
+
+  /* acknowledge the command once it has been applied */
+  if(!webSocket) return;
+  *(uint32_t *)(m_OutputBufferAck->constData() + 4) = sequence;
+  *(int32_t *)(m_OutputBufferAck->constData() + 8) = command;
+  prepareFrame(m_OutputBufferAck);
+  writeFrame(webSocket);
 }
 
 //------------------------------------------------------------------------------
@@ -414,6 +1505,107 @@ void Server::on_TimerTX_timeout()
 
 //------------------------------------------------------------------------------
 
+void Server::on_TimerMeter_timeout()
+{
+  int32_t i, value;
+  int16_t *pointer;
+  float meters[TXA_METERTYPE_LAST];
+
+  /* RX meters, then TX meters while transmitting, as tenths of dB */
+  GetRXAMeters(0, meters);
+  m_OutputBufferMeter->resize(RXA_METERTYPE_LAST * sizeof(int16_t) + 8);
+  *(uint32_t *)(m_OutputBufferMeter->constData() + 0) = 6;
+  *(int32_t *)(m_OutputBufferMeter->constData() + 4) = 0;
+  pointer = (int16_t *)(m_OutputBufferMeter->constData() + 8);
+  for(i = 0; i < RXA_METERTYPE_LAST; ++i)
+  {
+    value = int32_t(floor(meters[i] * 10.0 + 0.5));
+    if(value < -32768) value = -32768;
+    if(value > 32767) value = 32767;
+    *(pointer++) = value;
+  }
+  sendFrame(m_OutputBufferMeter);
+
+  if(m_WFMD)
+  {
+    /* pilot level in tenths of dB of full deviation, stereo blend, demodulator load in per mille and RX buffer overruns */
+    m_OutputBufferMeter->resize(4 * sizeof(int16_t) + 8);
+    *(int32_t *)(m_OutputBufferMeter->constData() + 4) = 2;
+    pointer = (int16_t *)(m_OutputBufferMeter->constData() + 8);
+    value = int32_t(floor(200.0 * log10(fabs(m_WFMD->pilot) + 1.0e-6) + 0.5));
+    *(pointer++) = value < -32768 ? -32768 : value;
+    *(pointer++) = int16_t(floor(m_WFMD->blend * 1000.0 + 0.5));
+    value = int32_t(floor(m_LoadWFM * 1000.0 + 0.5));
+    *(pointer++) = value > 32767 ? 32767 : value;
+    *(pointer++) = m_OverrunsRX > 32767 ? 32767 : m_OverrunsRX;
+    sendFrame(m_OutputBufferMeter);
+  }
+
+  if(!m_TimerTX->isActive()) return;
+
+  GetTXAMeters(1, meters);
+  m_OutputBufferMeter->resize(TXA_METERTYPE_LAST * sizeof(int16_t) + 8);
+  *(int32_t *)(m_OutputBufferMeter->constData() + 4) = 1;
+  pointer = (int16_t *)(m_OutputBufferMeter->constData() + 8);
+  for(i = 0; i < TXA_METERTYPE_LAST; ++i)
+  {
+    value = int32_t(floor(meters[i] * 10.0 + 0.5));
+    if(value < -32768) value = -32768;
+    if(value > 32767) value = 32767;
+    *(pointer++) = value;
+  }
+  sendFrame(m_OutputBufferMeter);
+}
+
+//------------------------------------------------------------------------------
+
+void Server::on_TimerZoom_timeout()
+{
+  int32_t i, value, rate;
+  int flag;
+  uint8_t *pointer;
+  int64_t cpu, wall;
+  double load;
+  struct timespec ts;
+
+  GetPixels(0, m_BufferZoom, &flag);
+  if(flag)
+  {
+    /* attenuations in dB like the FPGA FFT, centered on the RX frequency */
+    *(int32_t *)(m_OutputBufferZoom->constData() + 4) = m_FreqRX;
+    pointer = (uint8_t *)(m_OutputBufferZoom->constData() + 12);
+    for(i = 0; i < m_PixelsZoom; ++i)
+    {
+      value = int32_t(floor(-m_BufferZoom[i] + 0.5));
+      if(value < 0) value = 0;
+      if(value > 255) value = 255;
+      *(pointer++) = value;
+    }
+    sendFrame(m_OutputBufferZoom);
+  }
+
+  /* once per second, halve the frame rate while over the CPU budget and double it back when well under */
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  wall = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  if(wall - m_WallTimeZoom < 1000000) return;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  cpu = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  load = double(cpu - m_CPUTimeZoom) / (wall - m_WallTimeZoom);
+  rate = m_WallTimeZoom ? m_RateZoom : 0;
+  m_CPUTimeZoom = cpu;
+  m_WallTimeZoom = wall;
+  if(!rate) return;
+
+  if(load > ZoomBudget && rate > 1) rate /= 2;
+  else if(load < ZoomBudget / 2 && rate < m_LimitZoom) rate = rate * 2 < m_LimitZoom ? rate * 2 : m_LimitZoom;
+  if(rate == m_RateZoom) return;
+
+  m_RateZoom = rate;
+  configureZoom();
+}
+
+//------------------------------------------------------------------------------
+
 void Server::on_WebSocketServer_closed()
 {
   qApp->quit();
@@ -426,17 +1618,13 @@ void Server::on_WebSocketServer_newConnection()
   QWebSocket *webSocket = m_WebSocketServer->nextPendingConnection();
 
   printf("new connection\n");
-  if(m_WebSocket && webSocket)
-  {
-    printf("closing\n");
-    webSocket->close();
-    return;
-  }
+  if(!webSocket) return;
 
   connect(webSocket, SIGNAL(binaryMessageReceived(QByteArray)), this, SLOT(on_WebSocket_binaryMessageReceived(QByteArray)));
   connect(webSocket, SIGNAL(disconnected()), this, SLOT(on_WebSocket_disconnected()));
 
-  m_WebSocket = webSocket;
+  m_WebSockets.append(webSocket);
+  joinAudioGroup(webSocket, AudioGroup::DefaultRate, AudioGroup::DefaultChannels, AudioGroup::DefaultFormat, AudioGroup::DefaultFrames, false);
 }
 
 //------------------------------------------------------------------------------
@@ -449,7 +1637,15 @@ void Server::on_WebSocket_disconnected()
 
   printf("disconnected\n");
 
-  if(m_WebSocket == webSocket) m_WebSocket = 0;
+  m_WebSockets.removeAll(webSocket);
+  m_Sequence.remove(webSocket);
+  leaveAudioGroup(webSocket);
+  if(m_Waterfalls.contains(webSocket))
+  {
+    delete m_Waterfalls.take(webSocket);
+    updateTimerFFT();
+  }
+  if(m_StreamsIQ.contains(webSocket)) delete m_StreamsIQ.take(webSocket);
 
   webSocket->deleteLater();
 }
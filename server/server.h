@@ -23,50 +23,147 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QList>
+#include <QtCore/QMap>
 #include <QtCore/QByteArray>
 
-#include <samplerate.h>
-
 class QTimer;
+class QElapsedTimer;
 class QWebSocketServer;
 class QWebSocket;
 
+class Session;
+class Panorama;
+class Detector;
+class AudioGroup;
+class Waterfall;
+class IQStream;
+
+struct _pfb;
+struct _div;
+struct _wfmd;
+struct _shift;
+struct _resample;
+
 class Server: public QObject
 {
   Q_OBJECT
 
 public:
-  Server(int16_t port, QObject *parent = 0);
+  Server(int16_t port, const char *record = 0, const char *replay = 0, bool fast = false, QObject *parent = 0);
   virtual ~Server();
 
 private slots:
   void on_TimerRX_timeout();
   void on_TimerFFT_timeout();
   void on_TimerTX_timeout();
+  void on_TimerReplay_timeout();
+  void on_TimerMeter_timeout();
+  void on_TimerZoom_timeout();
   void on_WebSocketServer_closed();
   void on_WebSocketServer_newConnection();
   void on_WebSocket_binaryMessageReceived(QByteArray message);
   void on_WebSocket_disconnected();
 
 private:
+  void setupRX();
+  void changeRateRX(int32_t rate);
+  void updateRateRX();
+  void flushRX();
+  void startTimerRX();
+  void tuneRX(int32_t freq);
+  void processRX(int32_t *buffer);
+  void updateDIV();
+  void processFFT(int32_t *buffer);
+  void processCommand(QByteArray &message, QWebSocket *webSocket);
+  void startSweep();
+  void stopSweep();
+  void updateTimerFFT();
+  void sendWaterfalls();
+  void configureZoom();
+  void joinAudioGroup(QWebSocket *webSocket, int32_t rate, int32_t channels, int32_t format, int32_t frames, bool dtx);
+  void leaveAudioGroup(QWebSocket *webSocket);
+  AudioGroup *findAudioGroup(QWebSocket *webSocket);
+  void sendAudio(AudioGroup *group);
+  void sendIQ(float *buffer);
+  void hashFrame(QByteArray *frame);
+  void prepareFrame(QByteArray *frame);
+  void writeFrame(QWebSocket *webSocket);
+  void sendFrame(QByteArray *frame);
+  void sendFrame(QByteArray *frame, AudioGroup *group);
+
   uint32_t *m_Cfg;
   uint16_t *m_Sts;
   int32_t *m_BufferRX, *m_BufferTX, *m_BufferFFT;
+  int32_t *m_StagingFFT;
+  uint16_t m_StatusFFT;
   int m_LimitRX, m_InputOffsetRX;
+  int64_t m_TimeRX;
+  int32_t m_PositionRX, m_OverrunsRX;
   int m_LimitTX, m_InputOffsetTX;
   QByteArray *m_InputBufferRX;
-  QByteArray *m_OutputBufferRX;
   QByteArray *m_OutputBufferFFT;
-  int32_t m_CounterRX;
-  int16_t *m_PointerRX;
-  int32_t m_FreqMin;
-  SRC_STATE *m_StateRX;
-  SRC_DATA *m_DataRX;
+  QByteArray *m_OutputBufferSweep;
+  QByteArray *m_OutputBufferTap;
+  QByteArray *m_OutputBufferDetector;
+  QByteArray *m_OutputBufferCNG;
+  QByteArray *m_OutputBufferMeter;
+  QByteArray *m_OutputBufferAck;
+  QByteArray *m_BufferSend;
+  QMap<QWebSocket *, uint32_t> m_Sequence;
+  uint64_t m_CountRX;
+  int32_t m_FreqMin, m_FreqFFT;
+  int32_t m_FreqRX, m_CenterRX, m_OffsetRX;
+  bool m_HybridRX;
+  int32_t m_RateRX, m_RateDSP, m_PendingRateRX;
+  bool m_ResumeRX;
+  QList<QByteArray> m_CommandsRX;
+  bool m_EnableFFT;
+  bool m_EnableDetector;
+  Detector *m_Detector;
+  Panorama *m_Panorama;
+  QMap<QWebSocket *, Waterfall *> m_Waterfalls;
+  bool m_Sweep;
+  int32_t m_SweepFreqMin, m_SweepFreqMax, m_SweepPixels;
+  int32_t m_SweepStep, m_SweepSettle, m_SweepDwell, m_SweepInterval;
+  uint16_t m_StatusSweep;
+  bool m_EnableZoom;
+  int32_t m_SizeZoom, m_WindowZoom, m_PixelsZoom, m_SpanZoom;
+  int32_t m_RateZoom, m_LimitZoom;
+  float m_AverageZoom;
+  float *m_BufferZoom;
+  int64_t m_CPUTimeZoom, m_WallTimeZoom;
+  QByteArray *m_OutputBufferZoom;
+  struct _div *m_DIV;
+  float *m_BufferDIV;
+  int32_t m_CounterDIV;
+  bool m_AutoDIV;
+  float m_RotateDIV[2];
+  float m_CorrelationDIV[2], m_PowerDIV;
+  struct _wfmd *m_WFMD;
+  int32_t m_RateNFM;
+  float m_LoadWFM;
+  struct _pfb *m_PFB;
+  int32_t m_TapPFB;
+  QList<AudioGroup *> m_AudioGroups;
+  QMap<QWebSocket *, IQStream *> m_StreamsIQ;
   QTimer *m_TimerRX;
   QTimer *m_TimerFFT;
   QTimer *m_TimerTX;
+  QTimer *m_TimerReplay;
+  QTimer *m_TimerMeter;
+  QTimer *m_TimerZoom;
+  Session *m_Record;
+  Session *m_Replay;
+  QElapsedTimer *m_ReplayClock;
+  QByteArray *m_ReplayData;
+  uint32_t m_ReplayType;
+  int64_t m_ReplayTime;
+  bool m_ReplayPending;
+  bool m_ReplayFast;
+  uint64_t m_Hash;
+  uint64_t m_Frames;
   QWebSocketServer *m_WebSocketServer;
-  QWebSocket *m_WebSocket;
+  QList<QWebSocket *> m_WebSockets;
 };
 
 #endif
@@ -0,0 +1,135 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "session.h"
+
+static const char SessionMagic[4] = {'M', 'T', 'R', 'X'};
+static const uint32_t SessionVersion = 2;
+
+//------------------------------------------------------------------------------
+
+Session::Session():
+  m_File(0), m_Version(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+Session::~Session()
+{
+  close();
+}
+
+//------------------------------------------------------------------------------
+
+bool Session::openWrite(const char *name)
+{
+  close();
+
+  if(!(m_File = fopen(name, "wb")))
+  {
+    perror("fopen");
+    return false;
+  }
+
+  fwrite(SessionMagic, 1, 4, m_File);
+  fwrite(&SessionVersion, 4, 1, m_File);
+  m_Version = SessionVersion;
+
+  m_Timer.start();
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool Session::openRead(const char *name)
+{
+  char magic[4];
+  uint32_t version;
+
+  close();
+
+  if(!(m_File = fopen(name, "rb")))
+  {
+    perror("fopen");
+    return false;
+  }
+
+  if(fread(magic, 1, 4, m_File) != 4 || memcmp(magic, SessionMagic, 4) != 0 ||
+     fread(&version, 4, 1, m_File) != 1 || version < 1 || version > SessionVersion)
+  {
+    fprintf(stderr, "%s: not a session file\n", name);
+    close();
+    return false;
+  }
+
+  m_Version = version;
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+void Session::close()
+{
+  if(m_File) fclose(m_File);
+  m_File = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void Session::write(uint32_t type, const void *data, uint32_t size)
+{
+  uint32_t header[4];
+  int64_t time;
+
+  if(!m_File) return;
+
+  time = m_Timer.nsecsElapsed() / 1000;
+
+  header[0] = type;
+  header[1] = size;
+  memcpy(header + 2, &time, 8);
+
+  fwrite(header, 4, 4, m_File);
+  fwrite(data, 1, size, m_File);
+}
+
+//------------------------------------------------------------------------------
+
+bool Session::read(uint32_t *type, int64_t *time, QByteArray *data)
+{
+  uint32_t header[4];
+
+  if(!m_File) return false;
+
+  if(fread(header, 4, 4, m_File) != 4) return false;
+
+  *type = header[0];
+  memcpy(time, header + 2, 8);
+
+  data->resize(header[1]);
+  if(fread(data->data(), 1, header[1], m_File) != header[1]) return false;
+
+  return true;
+}
@@ -0,0 +1,61 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Session_h
+#define Session_h
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+
+// Session file layout: 8-byte file header ("MTRX" + version), then records
+// made of a 16-byte header (type, payload size, time in microseconds since
+// the start of the recording) followed by the payload.  The commands of
+// version 1 have no sequence number, their data follows the command.
+
+class Session
+{
+public:
+  enum Type
+  {
+    Command = 0,
+    SamplesRX = 1,
+    SamplesFFT = 2
+  };
+
+  Session();
+  ~Session();
+
+  bool openWrite(const char *name);
+  bool openRead(const char *name);
+  void close();
+
+  void write(uint32_t type, const void *data, uint32_t size);
+  bool read(uint32_t *type, int64_t *time, QByteArray *data);
+
+  uint32_t version() const { return m_Version; }
+
+private:
+  FILE *m_File;
+  uint32_t m_Version;
+  QElapsedTimer m_Timer;
+};
+
+#endif
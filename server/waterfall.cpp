@@ -0,0 +1,104 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include "waterfall.h"
+
+//------------------------------------------------------------------------------
+
+Waterfall::Waterfall(int32_t width, int32_t rows, int32_t low, int32_t high):
+  m_Width(width), m_Rows(rows), m_Low(low), m_High(high),
+  m_Row(0), m_Data(0), m_Frame(0)
+{
+  int32_t i, value;
+
+  /* the strongest signals get the highest index */
+  for(i = 0; i < 256; ++i)
+  {
+    value = (m_High - i) * 255 / (m_High - m_Low);
+    if(value < 0) value = 0;
+    if(value > 255) value = 255;
+    m_Palette[i] = value;
+  }
+
+  m_Data = new uint8_t[m_Width * m_Rows];
+
+  m_Frame = new QByteArray();
+}
+
+//------------------------------------------------------------------------------
+
+Waterfall::~Waterfall()
+{
+  delete [] m_Data;
+  delete m_Frame;
+}
+
+//------------------------------------------------------------------------------
+
+bool Waterfall::matches(int32_t width, int32_t rows, int32_t low, int32_t high) const
+{
+  return m_Width == width && m_Rows == rows && m_Low == low && m_High == high;
+}
+
+//------------------------------------------------------------------------------
+
+bool Waterfall::add(const uint8_t *bins)
+{
+  int32_t i, j, first, last;
+  uint8_t value, *row, *above;
+  QByteArray data;
+
+  /* the values are attenuations, so the strongest bin has the lowest value */
+  row = m_Data + m_Row * m_Width;
+  first = 0;
+  for(i = 0; i < m_Width; ++i)
+  {
+    last = (i + 1) * 4096 / m_Width;
+    value = bins[first];
+    for(j = first + 1; j < last; ++j)
+    {
+      if(bins[j] < value) value = bins[j];
+    }
+    row[i] = m_Palette[value];
+    first = last;
+  }
+
+  if(++m_Row < m_Rows) return false;
+  m_Row = 0;
+
+  /* filter from the bottom up, so that every row is still intact when it is used as the row above */
+  for(i = m_Rows - 1; i > 0; --i)
+  {
+    row = m_Data + i * m_Width;
+    above = row - m_Width;
+    for(j = 0; j < m_Width; ++j) row[j] -= above[j];
+  }
+
+  data = qCompress(m_Data, m_Width * m_Rows);
+
+  m_Frame->resize(data.size() + 16);
+  *(uint32_t *)(m_Frame->constData() + 0) = 11;
+  *(uint16_t *)(m_Frame->constData() + 12) = m_Width;
+  *(uint16_t *)(m_Frame->constData() + 14) = m_Rows;
+  memcpy((char *)m_Frame->constData() + 16, data.constData(), data.size());
+
+  return true;
+}
@@ -0,0 +1,54 @@
+/*
+ *  MiniTRX: minimalist user interface for the Red Pitaya SDR transceiver
+ *  Copyright (C) 2014-2015  Pavel Demin
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Waterfall_h
+#define Waterfall_h
+
+#include <stdint.h>
+
+#include <QtCore/QByteArray>
+
+// Waterfall rows for thin clients.  The 4096 bins of the FPGA FFT are
+// reduced to the width of the client, keeping the strongest bin of each
+// pixel, and mapped to palette indices between the weakest ('high') and the
+// strongest ('low') attenuation in dB.  The rows are collected into tiles,
+// each row but the first is replaced by its difference to the row above, as
+// with the 'up' filter of PNG, and the tile is deflated with qCompress, so
+// that the client only has to inflate, sum up the columns and blit.
+
+class Waterfall
+{
+public:
+  Waterfall(int32_t width, int32_t rows, int32_t low, int32_t high);
+  ~Waterfall();
+
+  bool matches(int32_t width, int32_t rows, int32_t low, int32_t high) const;
+
+  bool add(const uint8_t *bins);
+
+  QByteArray *frame() { return m_Frame; }
+
+private:
+  int32_t m_Width, m_Rows, m_Low, m_High;
+  int32_t m_Row;
+  uint8_t m_Palette[256];
+  uint8_t *m_Data;
+  QByteArray *m_Frame;
+};
+
+#endif
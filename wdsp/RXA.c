@@ -33,6 +33,19 @@ void create_rxa (int channel)
 	rxa[channel].outbuff = (float *) malloc0 (1 * ch[channel].dsp_outsize * sizeof (complex));
 	rxa[channel].midbuff = (float *) malloc0 (2 * ch[channel].dsp_size    * sizeof (complex));
 
+	// noise blanker, ahead of everything else so that impulses are removed at full bandwidth
+	rxa[channel].anb.p = create_anb (
+		0,												// run
+		ch[channel].dsp_insize,							// input buffer size
+		rxa[channel].inbuff,							// pointer to input buffer
+		rxa[channel].inbuff,							// pointer to output buffer
+		ch[channel].in_rate,							// samplerate
+		0.0001,											// transition time (sec)
+		0.0001,											// hang time (sec)
+		0.0001,											// advance time (sec)
+		0.05,											// time constant of the average magnitude (sec)
+		5.0);											// threshold, times the average magnitude
+
 	// shift to select a slice of spectrum
 	rxa[channel].shift.p = create_shift (
 		1,												// run
@@ -73,7 +86,7 @@ void create_rxa (int channel)
 		0.100,											// averaging time constant
 		0.100,											// peak decay time constant
 		rxa[channel].meter,								// result vector
-		rxa[channel].pmtupdate,							// locks for meter access
+		&rxa[channel].mtseq,							// sequence counter for meter access
 		RXA_ADC_AV,										// index for average value
 		RXA_ADC_PK,										// index for peak value
 		-1,												// index for gain value
@@ -114,7 +127,7 @@ void create_rxa (int channel)
 		0.100,											// averaging time constant
 		0.100,											// peak decay time constant
 		rxa[channel].meter,								// result vector
-		rxa[channel].pmtupdate,							// locks for meter access
+		&rxa[channel].mtseq,							// sequence counter for meter access
 		RXA_S_AV,										// index for average value
 		RXA_S_PK,										// index for peak value
 		-1,												// index for gain value
@@ -304,7 +317,7 @@ void create_rxa (int channel)
 		0.100,											// averaging time constant
 		0.100,											// peak decay time constant
 		rxa[channel].meter,								// result vector
-		rxa[channel].pmtupdate,							// locks for meter access
+		&rxa[channel].mtseq,							// sequence counter for meter access
 		RXA_AGC_AV,										// index for average value
 		RXA_AGC_PK,										// index for peak value
 		RXA_AGC_GAIN,									// index for gain value
@@ -430,6 +443,7 @@ void destroy_rxa (int channel)
 	destroy_gen (rxa[channel].gen0.p);
 	destroy_resample (rxa[channel].rsmpin.p);
 	destroy_shift (rxa[channel].shift.p);
+	destroy_anb (rxa[channel].anb.p);
 	_aligned_free (rxa[channel].midbuff);
 	_aligned_free (rxa[channel].outbuff);
 	_aligned_free (rxa[channel].inbuff);
@@ -440,6 +454,7 @@ void flush_rxa (int channel)
 	memset (rxa[channel].inbuff,  0, 1 * ch[channel].dsp_insize  * sizeof (complex));
 	memset (rxa[channel].outbuff, 0, 1 * ch[channel].dsp_outsize * sizeof (complex));
 	memset (rxa[channel].midbuff, 0, 2 * ch[channel].dsp_size    * sizeof (complex));
+	flush_anb (rxa[channel].anb.p);
 	flush_shift (rxa[channel].shift.p);
 	flush_resample (rxa[channel].rsmpin.p);
 	flush_gen (rxa[channel].gen0.p);
@@ -468,13 +483,14 @@ void flush_rxa (int channel)
 
 void xrxa (int channel)
 {
+	xanb (rxa[channel].anb.p);
 	xshift (rxa[channel].shift.p);
 	xresample (rxa[channel].rsmpin.p);
 	xgen (rxa[channel].gen0.p);
 	xmeter (rxa[channel].adcmeter.p);
+	xsender (rxa[channel].sender.p);
 	xbandpass (rxa[channel].bp0.p, 0);
 	xmeter (rxa[channel].smeter.p);
-	xsender (rxa[channel].sender.p);
 	xamsqcap (rxa[channel].amsq.p);
 	xamd (rxa[channel].amd.p);
 	xfmd (rxa[channel].fmd.p);
@@ -63,12 +63,16 @@ struct _rxa
 	float* midbuff;
 	int mode;
 	float meter[RXA_METERTYPE_LAST];
-	CRITICAL_SECTION* pmtupdate[RXA_METERTYPE_LAST];
+	volatile long mtseq;
 	struct
 	{
 		METER p;
 	} smeter, adcmeter, agcmeter;
 	struct
+	{
+		ANB p;
+	} anb;
+	struct
 	{
 		SHIFT p;
 	} shift;
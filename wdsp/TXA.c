@@ -73,7 +73,7 @@ void create_txa (int channel)
 		0.100,										// averaging time constant
 		0.100,										// peak decay time constant
 		txa[channel].meter,							// result vector
-		txa[channel].pmtupdate,						// locks for meter access
+		&txa[channel].mtseq,						// sequence counter for meter access
 		TXA_MIC_AV,									// index for average value
 		TXA_MIC_PK,									// index for peak value
 		-1,											// index for gain value
@@ -121,7 +121,7 @@ void create_txa (int channel)
 		0.100,										// averaging time constant
 		0.100,										// peak decay time constant
 		txa[channel].meter,							// result vector
-		txa[channel].pmtupdate,						// locks for meter access
+		&txa[channel].mtseq,						// sequence counter for meter access
 		TXA_EQ_AV,									// index for average value
 		TXA_EQ_PK,									// index for peak value
 		-1,											// index for gain value
@@ -172,7 +172,7 @@ void create_txa (int channel)
 		0.100,										// averaging time constant
 		0.100,										// peak decay time constant
 		txa[channel].meter,							// result vector
-		txa[channel].pmtupdate,						// locks for meter access
+		&txa[channel].mtseq,						// sequence counter for meter access
 		TXA_LVLR_AV,								// index for average value
 		TXA_LVLR_PK,								// index for peak value
 		TXA_LVLR_GAIN,								// index for gain value
@@ -257,7 +257,7 @@ void create_txa (int channel)
 		0.100,										// averaging time constant
 		0.100,										// peak decay time constant
 		txa[channel].meter,							// result vector
-		txa[channel].pmtupdate,						// locks for meter access
+		&txa[channel].mtseq,						// sequence counter for meter access
 		TXA_COMP_AV,								// index for average value
 		TXA_COMP_PK,								// index for peak value
 		-1,											// index for gain value
@@ -338,7 +338,7 @@ void create_txa (int channel)
 		0.100,										// averaging time constant
 		0.100,										// peak decay time constant
 		txa[channel].meter,							// result vector
-		txa[channel].pmtupdate,						// locks for meter access
+		&txa[channel].mtseq,						// sequence counter for meter access
 		TXA_ALC_AV,									// index for average value
 		TXA_ALC_PK,									// index for peak value
 		TXA_ALC_GAIN,								// index for gain value
@@ -396,7 +396,7 @@ void create_txa (int channel)
 		0.100,										// averaging time constant
 		0.100,										// peak decay time constant
 		txa[channel].meter,							// result vector
-		txa[channel].pmtupdate,						// locks for meter access
+		&txa[channel].mtseq,						// sequence counter for meter access
 		TXA_OUT_AV,									// index for average value
 		TXA_OUT_PK,									// index for peak value
 		-1,											// index for gain value
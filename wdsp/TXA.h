@@ -70,7 +70,7 @@ struct _txa
 	float* midbuff;
 	int mode;
 	float meter[TXA_METERTYPE_LAST];
-	CRITICAL_SECTION* pmtupdate[TXA_METERTYPE_LAST];
+	volatile long mtseq;
 	struct
 	{
 		METER p;
@@ -204,6 +204,14 @@ void SetRXAAMSQMaxTail (int channel, float tail)
 	LeaveCriticalSection (&ch[channel].csDSP);
 }
 
+PORT
+int GetRXAAMSQMuted (int channel)
+{
+	// no csDSP here, it is held for a whole DSP buffer and the state is a single int
+	AMSQ a = rxa[channel].amsq.p;
+	return a->run && a->state == MUTED;
+}
+
 /********************************************************************************************************
 *																										*
 *											TXA Properties												*
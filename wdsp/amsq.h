@@ -72,6 +72,8 @@ extern __declspec (dllexport) void SetRXAAMSQThreshold (int channel, float thres
 
 extern __declspec (dllexport) void SetRXAAMSQMaxTail (int channel, float tail);
 
+extern __declspec (dllexport) int GetRXAAMSQMuted (int channel);
+
 // TXA Properties
 
 extern __declspec (dllexport) void SetTXAAMSQRun (int channel, int run);
@@ -538,6 +538,7 @@ DWORD WINAPI spectra (void *pargs)
 			for (j = 0; j < dMAX_STITCH; j++)
 				for (i = 0; i < dMAX_NUM_FFT; i++)
 					InterlockedBitTestAndReset(&(a->input_busy[j][i]), 0);
+			SetEvent(a->hDispatchEvent);
 			stitch(disp);
 		}
 		else
@@ -623,6 +624,7 @@ DWORD WINAPI Cspectra (void *pargs)
 			for (j = 0; j < dMAX_STITCH; j++)
 				for (i = 0; i < dMAX_NUM_FFT; i++)
 					InterlockedBitTestAndReset(&(a->input_busy[j][i]), 0);
+			SetEvent(a->hDispatchEvent);
 			stitch(disp);
 		}
 		else
@@ -801,7 +803,7 @@ void __cdecl sendbuf(void *arg)
 					LeaveCriticalSection(&(a->BufferControlSection[a->ss][a->LO]));
 				}
 			}
-			Sleep(1);
+		WaitForSingleObject(a->hDispatchEvent, INFINITE);
 	}
 	a->dispatcher = 0;
 	_endthread();
@@ -836,6 +838,7 @@ void SetAnalyzer (	int disp,
 
 	EnterCriticalSection(&a->SetAnalyzerSection);
 	a->end_dispatcher = 1;
+	SetEvent(a->hDispatchEvent);
 	while (a->dispatcher)
 		Sleep(1);
 	a->stop = 1;
@@ -925,6 +928,7 @@ void SetAnalyzer (	int disp,
 
 	if (sz != a->size)
 	{
+		EnterPlanner ();
 		for (i = 0; i < a->max_stitch; i++)
 			for (j = 0; j < a->max_num_fft; j++)
 			{
@@ -933,6 +937,7 @@ void SetAnalyzer (	int disp,
 				a->plan[i][j] = fftwf_plan_dft_r2c_1d(sz, a->fft_in[i][j], a->fft_out[i][j], FFTW_PATIENT);
 				a->Cplan[i][j] = fftwf_plan_dft_1d(sz, a->Cfft_in[i][j], a->fft_out[i][j], FFTW_FORWARD, FFTW_PATIENT);
 			}
+		LeavePlanner ();
 	}
 
 	if ((sz != a->size) || (win_type != a->window_type) || (pi != a->PiAlpha))
@@ -1048,6 +1053,12 @@ void XCreateAnalyzer(	int disp,
 	
 	a->pnum_threads = (LONG*) malloc0 (sizeof (LONG));
 
+#ifdef linux
+	CreateEvent(&a->hDispatchEvent, NULL, FALSE, FALSE, "dispatch");
+#else
+	a->hDispatchEvent = CreateEvent(NULL, FALSE, FALSE, TEXT("dispatch"));
+#endif
+
 	for (i = 0; i < a->max_stitch; i++)
 		for (j = 0; j < a->max_num_fft; j++)
 		{
@@ -1165,8 +1176,12 @@ void DestroyAnalyzer(int disp)
 	int i, j;
 
 	a->end_dispatcher = 1;
+	SetEvent(a->hDispatchEvent);
 	while (a->dispatcher)
 		Sleep(1);
+	a->stop = 1;
+	while (_InterlockedAnd(a->pnum_threads, 1023))
+		Sleep(1);
 
 	for (i = 0; i < a->max_stitch; i++)
 		for (j = 0; j < a->max_num_fft; j++)
@@ -1203,8 +1218,10 @@ void DestroyAnalyzer(int disp)
 	for (i = 0; i < a->max_stitch; i++)
 		for (j = 0; j < a->max_num_fft; j++)
 		{
+			EnterPlanner ();
 			fftwf_destroy_plan (a->plan[i][j]);
 			fftwf_destroy_plan (a->Cplan[i][j]);
+			LeavePlanner ();
 			fftwf_free (a->Cfft_in[i][j]);
 			_aligned_free (a->fft_in[i][j]);
 			fftwf_free (a->fft_out[i][j]);
@@ -1229,6 +1246,8 @@ void DestroyAnalyzer(int disp)
 		for (j = 0; j < a->max_num_fft; j++)
 			CloseHandle(a->hSnapEvent[i][j]);
 
+	CloseHandle(a->hDispatchEvent);
+
 	_aligned_free ((void *) a->pnum_threads);
 
 	_aligned_free (a);
@@ -1354,7 +1373,10 @@ void CloseBuffer(int disp, int ss, int LO)
 				a->have_samples[ss][LO] = a->max_writeahead;
 			}
 		if ((a->have_samples[ss][LO] += a->buff_size) >= a->size)
+		{
 			InterlockedBitTestAndSet(&(a->buff_ready[ss][LO]), 0);
+			SetEvent(a->hDispatchEvent);
+		}
 	LeaveCriticalSection(&(a->BufferControlSection[ss][LO]));
 	if((a->IQin_index[ss][LO] += a->buff_size) >= a->bsize)	//REQUIRES buff_size IS A SUB-MULTIPLE OF SIZE OF INPUT SAMPLE BUFFS!
 		a->IQin_index[ss][LO] = 0;
@@ -1393,7 +1415,10 @@ void Spectrum(int disp, int ss, int LO, dINREAL* pI, dINREAL* pQ)
 				a->have_samples[ss][LO] = a->max_writeahead;
 			}
 		if ((a->have_samples[ss][LO] += a->buff_size) >= a->size)
+		{
 			InterlockedBitTestAndSet(&(a->buff_ready[ss][LO]), 0);
+			SetEvent(a->hDispatchEvent);
+		}
 	LeaveCriticalSection(&(a->BufferControlSection[ss][LO]));
 	if((a->IQin_index[ss][LO] += a->buff_size) >= a->bsize)	//REQUIRES buff_size IS A SUB-MULTIPLE OF SIZE OF INPUT SAMPLE BUFFS!
 		a->IQin_index[ss][LO] = 0;
@@ -1436,7 +1461,10 @@ void Spectrum2(int disp, int ss, int LO, dINREAL* pbuff)
 				a->have_samples[ss][LO] = a->max_writeahead;
 			}
 		if ((a->have_samples[ss][LO] += a->buff_size) >= a->size)
+		{
 			InterlockedBitTestAndSet(&(a->buff_ready[ss][LO]), 0);
+			SetEvent(a->hDispatchEvent);
+		}
 	LeaveCriticalSection(&(a->BufferControlSection[ss][LO]));
 	if((a->IQin_index[ss][LO] += a->buff_size) >= a->bsize)	//REQUIRES buff_size IS A SUB-MULTIPLE OF SIZE OF INPUT SAMPLE BUFFS!
 		a->IQin_index[ss][LO] = 0;
@@ -1481,7 +1509,10 @@ void Spectrum0(int run, int disp, int ss, int LO, float* pbuff)
 					a->have_samples[ss][LO] = a->max_writeahead;
 				}
 			if ((a->have_samples[ss][LO] += a->buff_size) >= a->size)
+			{
 				InterlockedBitTestAndSet(&(a->buff_ready[ss][LO]), 0);
+				SetEvent(a->hDispatchEvent);
+			}
 		LeaveCriticalSection(&(a->BufferControlSection[ss][LO]));
 		if((a->IQin_index[ss][LO] += a->buff_size) >= a->bsize)	//REQUIRES buff_size IS A SUB-MULTIPLE OF SIZE OF INPUT SAMPLE BUFFS!
 			a->IQin_index[ss][LO] = 0;
@@ -108,6 +108,7 @@ typedef struct _dp
 	int stop;											//when set, fft threads will be returned to the pool
 	int end_dispatcher;									//set this flag to one to destroy the dispatcher thread
 	int dispatcher;										//one if the dispatcher thread is alive & active
+	HANDLE hDispatchEvent;								//signalled when a buffer fills or inputs are released
 	int ss;												//sub-span being processed
 	int LO;												//LO (within current sub-span) being processed 
 	int flag;
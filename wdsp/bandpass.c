@@ -45,16 +45,20 @@ BANDPASS create_bandpass (int run, int position, int size, float* in, float* out
 	a->product = (float *) malloc0 (2 * a->size * sizeof (complex));
 	impulse = fir_bandpass (a->size + 1, f_low, f_high, a->samplerate, a->wintype, 1, 1.0 / (float)(2 * a->size));
 	a->mults = fftcv_mults (2 * a->size, impulse);
+	EnterPlanner ();
 	a->CFor = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->infilt,  (fftwf_complex *)a->product, FFTW_FORWARD,  FFTW_PATIENT);
 	a->CRev = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->product, (fftwf_complex *)a->out, FFTW_BACKWARD, FFTW_PATIENT);
+	LeavePlanner ();
 	_aligned_free (impulse);
 	return a;
 }
 
 void destroy_bandpass (BANDPASS a)
 {
+	EnterPlanner ();
 	fftwf_destroy_plan (a->CRev);
 	fftwf_destroy_plan (a->CFor);
+	LeavePlanner ();
 	_aligned_free (a->mults);
 	_aligned_free (a->product);
 	_aligned_free (a->infilt);
@@ -88,6 +92,64 @@ void xbandpass (BANDPASS a, int pos)
 		memcpy (a->out, a->in, a->size * sizeof (complex));
 }
 
+/********************************************************************************************************
+*																										*
+*											Filter Updates												*
+*																										*
+********************************************************************************************************/
+
+// Designing the filter, and the FFTW_PATIENT planning inside fftcv_mults(), can take far longer than
+// a DSP block.  The setters therefore record the new parameters, design the multipliers without
+// holding csDSP, and only swap the pointer under it.  A design that a later call has overtaken no
+// longer matches the recorded parameters and is dropped.  'freqs' selects whether the corner
+// frequencies or the window type are being changed; the other parameter is kept.  Without csDSP
+// the planning may overlap with other planners, fftcv_mults() serializes it with EnterPlanner().
+
+void update_bandpass (int channel, BANDPASS* slot, int freqs, float f_low, float f_high, int wintype)
+{
+	BANDPASS a;
+	float* impulse;
+	float* mults;
+	int size;
+	float samplerate;
+	EnterCriticalSection (&ch[channel].csDSP);
+	a = *slot;
+	if (freqs)
+		wintype = a->wintype;
+	else
+	{
+		f_low = a->f_low;
+		f_high = a->f_high;
+	}
+	if ((f_low == a->f_low) && (f_high == a->f_high) && (wintype == a->wintype))
+	{
+		LeaveCriticalSection (&ch[channel].csDSP);
+		return;
+	}
+	a->f_low = f_low;
+	a->f_high = f_high;
+	a->wintype = wintype;
+	size = a->size;
+	samplerate = a->samplerate;
+	LeaveCriticalSection (&ch[channel].csDSP);
+
+	impulse = fir_bandpass (size + 1, f_low, f_high, samplerate, wintype, 1, 1.0 / (float)(2 * size));
+	mults = fftcv_mults (2 * size, impulse);
+	_aligned_free (impulse);
+
+	EnterCriticalSection (&ch[channel].csDSP);
+	a = *slot;	// the stage may have been rebuilt meanwhile
+	if ((f_low == a->f_low) && (f_high == a->f_high) && (wintype == a->wintype) &&
+		(size == a->size) && (samplerate == a->samplerate))
+	{
+		impulse = a->mults;
+		a->mults = mults;
+		mults = impulse;
+	}
+	LeaveCriticalSection (&ch[channel].csDSP);
+	_aligned_free (mults);
+}
+
 /********************************************************************************************************
 *																										*
 *											RXA Properties												*
@@ -106,49 +168,15 @@ void SetRXABandpassRun (int channel, int run)
 PORT
 void SetRXABandpassFreqs (int channel, float f_low, float f_high)
 {
-	float* impulse;
-	BANDPASS a0, a1;
-	EnterCriticalSection (&ch[channel].csDSP);
-	a0 = rxa[channel].bp0.p;
-	a1 = rxa[channel].bp1.p;
-	if ((f_low != a0->f_low) || (f_high != a0->f_high) || (f_low != a1->f_low) || (f_high != a1->f_high))
-	{
-		a0->f_low = a1->f_low = f_low;
-		a0->f_high = a1->f_high = f_high;
-		_aligned_free (a0->mults);
-		impulse = fir_bandpass(a0->size + 1, f_low, f_high, a0->samplerate, a0->wintype, 1, 1.0 / (float)(2 * a0->size));
-		a0->mults = fftcv_mults (2 * a0->size, impulse);
-		_aligned_free (impulse);
-		_aligned_free (a1->mults);
-		impulse = fir_bandpass(a1->size + 1, f_low, f_high, a1->samplerate, a1->wintype, 1, 1.0 / (float)(2 * a1->size));
-		a1->mults = fftcv_mults (2 * a1->size, impulse);
-		_aligned_free (impulse);
-	}
-	LeaveCriticalSection (&ch[channel].csDSP);
+	update_bandpass (channel, &rxa[channel].bp0.p, 1, f_low, f_high, 0);
+	update_bandpass (channel, &rxa[channel].bp1.p, 1, f_low, f_high, 0);
 }
 
 PORT
 void SetRXABandpassWindow (int channel, int wintype)
 {
-	float* impulse;
-	BANDPASS a0, a1;
-	EnterCriticalSection (&ch[channel].csDSP);
-	a0 = rxa[channel].bp0.p;
-	a1 = rxa[channel].bp1.p;
-	if ((a0->wintype != wintype) || (a1->wintype != wintype))
-	{
-		a0->wintype = wintype;
-		a1->wintype = wintype;
-		_aligned_free (a0->mults);
-		impulse = fir_bandpass(a0->size + 1, a0->f_low, a0->f_high, a0->samplerate, a0->wintype, 1, 1.0 / (float)(2 * a0->size));
-		a0->mults = fftcv_mults (2 * a0->size, impulse);
-		_aligned_free (impulse);
-		_aligned_free (a1->mults);
-		impulse = fir_bandpass(a1->size + 1, a1->f_low, a1->f_high, a1->samplerate, a1->wintype, 1, 1.0 / (float)(2 * a1->size));
-		a1->mults = fftcv_mults (2 * a1->size, impulse);
-		_aligned_free (impulse);
-	}
-	LeaveCriticalSection (&ch[channel].csDSP);
+	update_bandpass (channel, &rxa[channel].bp0.p, 0, 0.0, 0.0, wintype);
+	update_bandpass (channel, &rxa[channel].bp1.p, 0, 0.0, 0.0, wintype);
 }
 
 /********************************************************************************************************
@@ -168,74 +196,15 @@ void SetTXABandpassRun (int channel, int run)
 PORT
 void SetTXABandpassFreqs (int channel, float f_low, float f_high)
 {
-	float* impulse;
-	BANDPASS a;
-	EnterCriticalSection (&ch[channel].csDSP);
-	a = txa[channel].bp0.p;
-	if ((f_low != a->f_low) || (f_high != a->f_high))
-	{
-		a->f_low = f_low;
-		a->f_high = f_high;
-		_aligned_free (a->mults);
-		impulse = fir_bandpass(a->size + 1, f_low, f_high, a->samplerate, a->wintype, 1, 1.0 / (float)(2 * a->size));
-		a->mults = fftcv_mults (2 * a->size, impulse);
-		_aligned_free (impulse);
-	}
-	a = txa[channel].bp1.p;
-	if ((f_low != a->f_low) || (f_high != a->f_high))
-	{
-		a->f_low = f_low;
-		a->f_high = f_high;
-		_aligned_free (a->mults);
-		impulse = fir_bandpass(a->size + 1, f_low, f_high, a->samplerate, a->wintype, 1, 1.0 / (float)(2 * a->size));
-		a->mults = fftcv_mults (2 * a->size, impulse);
-		_aligned_free (impulse);
-	}
-	a = txa[channel].bp2.p;
-	if ((f_low != a->f_low) || (f_high != a->f_high))
-	{
-		a->f_low = f_low;
-		a->f_high = f_high;
-		_aligned_free (a->mults);
-		impulse = fir_bandpass(a->size + 1, f_low, f_high, a->samplerate, a->wintype, 1, 1.0 / (float)(2 * a->size));
-		a->mults = fftcv_mults (2 * a->size, impulse);
-		_aligned_free (impulse);
-	}
-	LeaveCriticalSection (&ch[channel].csDSP);
+	update_bandpass (channel, &txa[channel].bp0.p, 1, f_low, f_high, 0);
+	update_bandpass (channel, &txa[channel].bp1.p, 1, f_low, f_high, 0);
+	update_bandpass (channel, &txa[channel].bp2.p, 1, f_low, f_high, 0);
 }
 
 PORT
 void SetTXABandpassWindow (int channel, int wintype)
 {
-	float* impulse;
-	BANDPASS a;
-	EnterCriticalSection (&ch[channel].csDSP);
-	a = txa[channel].bp0.p;
-	if (a->wintype != wintype)
-	{
-		a->wintype = wintype;
-		_aligned_free (a->mults);
-		impulse = fir_bandpass(a->size + 1, a->f_low, a->f_high, a->samplerate, a->wintype, 1, 1.0 / (float)(2 * a->size));
-		a->mults = fftcv_mults (2 * a->size, impulse);
-		_aligned_free (impulse);
-	}
-	a = txa[channel].bp1.p;
-	if (a->wintype != wintype)
-	{
-		a->wintype = wintype;
-		_aligned_free (a->mults);
-		impulse = fir_bandpass(a->size + 1, a->f_low, a->f_high, a->samplerate, a->wintype, 1, 1.0 / (float)(2 * a->size));
-		a->mults = fftcv_mults (2 * a->size, impulse);
-		_aligned_free (impulse);
-	}
-	a = txa[channel].bp2.p;
-	if (a->wintype != wintype)
-	{
-		a->wintype = wintype;
-		_aligned_free (a->mults);
-		impulse = fir_bandpass (a->size + 1, a->f_low, a->f_high, a->samplerate, a->wintype, 1, 1.0 / (float)(2 * a->size));
-		a->mults = fftcv_mults (2 * a->size, impulse);
-		_aligned_free (impulse);
-	}
-	LeaveCriticalSection (&ch[channel].csDSP);
+	update_bandpass (channel, &txa[channel].bp0.p, 0, 0.0, 0.0, wintype);
+	update_bandpass (channel, &txa[channel].bp1.p, 0, 0.0, 0.0, wintype);
+	update_bandpass (channel, &txa[channel].bp2.p, 0, 0.0, 0.0, wintype);
 }
\ No newline at end of file
@@ -55,6 +55,8 @@ extern void flush_bandpass (BANDPASS a);
 
 extern void xbandpass (BANDPASS a, int pos);
 
+extern void update_bandpass (int channel, BANDPASS* slot, int freqs, float f_low, float f_high, int wintype);
+
 // RXA Prototypes
 
 extern __declspec (dllexport) void SetRXABandpassRun (int channel, int run);
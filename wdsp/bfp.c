@@ -0,0 +1,132 @@
+/*  bfp.c
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2015 Pavel Demin
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#include "comm.h"
+
+/********************************************************************************************************
+*																										*
+*									Block Floating Point IQ Codec										*
+*																										*
+*	'n' complex int samples are coded in blocks of 'block' complex samples (the last one may be			*
+*	shorter).  Each block is one exponent byte 'e' followed by the I and Q mantissas, 'bits' bits		*
+*	each (2 to 16), packed LSB first.  A sample is decoded as mantissa * 2^e.							*
+*																										*
+********************************************************************************************************/
+
+PORT
+int bfp_size (int n, int bits, int block)
+{
+	int full = n / block;
+	int rest = n % block;
+	int size = full * (1 + (2 * block * bits + 7) / 8);
+	if (rest > 0) size += 1 + (2 * rest * bits + 7) / 8;
+	return size;
+}
+
+PORT
+int bfp_pack (int n, int* in, int bits, int block, unsigned char* out)
+{
+	int i, j, m, e, count;
+	int maxabs, limit, v;
+	unsigned int acc = 0;
+	int nacc = 0;
+	unsigned char* p = out;
+	unsigned int mask = (1u << bits) - 1;
+	limit = (1 << (bits - 1)) - 1;
+	for (i = 0; i < n; i += block)
+	{
+		count = n - i < block ? n - i : block;
+		maxabs = 0;
+		for (j = 0; j < 2 * count; j++)
+		{
+			v = in[2 * i + j];
+			if (v < 0) v = v == (int)0x80000000 ? 0x7fffffff : -v;
+			if (v > maxabs) maxabs = v;
+		}
+		e = 0;
+		while ((maxabs >> e) > limit) e++;
+		// flush the partial byte so that every block starts on a byte boundary
+		if (nacc > 0)
+		{
+			*p++ = (unsigned char)acc;
+			acc = 0;
+			nacc = 0;
+		}
+		*p++ = (unsigned char)e;
+		for (j = 0; j < 2 * count; j++)
+		{
+			v = in[2 * i + j];
+			if (e > 0)
+			{
+				// round to nearest, without overflowing the mantissa
+				m = (int)(((long long)v + (1LL << (e - 1))) >> e);
+				if (m > limit) m = limit;
+			}
+			else
+				m = v;
+			acc |= ((unsigned int)m & mask) << nacc;
+			nacc += bits;
+			while (nacc >= 8)
+			{
+				*p++ = (unsigned char)acc;
+				acc >>= 8;
+				nacc -= 8;
+			}
+		}
+	}
+	if (nacc > 0) *p++ = (unsigned char)acc;
+	return (int)(p - out);
+}
+
+PORT
+int bfp_unpack (int n, unsigned char* in, int bits, int block, float* out, float scale)
+{
+	int i, j, e, count, m;
+	unsigned int acc = 0;
+	int nacc = 0;
+	unsigned char* p = in;
+	unsigned int mask = (1u << bits) - 1;
+	unsigned int sign = 1u << (bits - 1);
+	float mult;
+	for (i = 0; i < n; i += block)
+	{
+		count = n - i < block ? n - i : block;
+		acc = 0;
+		nacc = 0;
+		e = *p++;
+		mult = ldexp (scale, e);
+		for (j = 0; j < 2 * count; j++)
+		{
+			while (nacc < bits)
+			{
+				acc |= (unsigned int)(*p++) << nacc;
+				nacc += 8;
+			}
+			m = (int)(acc & mask);
+			if (m & sign) m -= (int)(mask + 1);
+			acc >>= bits;
+			nacc -= bits;
+			out[2 * i + j] = mult * (float)m;
+		}
+	}
+	return (int)(p - in);
+}
@@ -0,0 +1,32 @@
+/*  bfp.h
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2015 Pavel Demin
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#ifndef _bfp_h
+#define _bfp_h
+
+extern int bfp_size (int n, int bits, int block);
+
+extern int bfp_pack (int n, int* in, int bits, int block, unsigned char* out);
+
+extern int bfp_unpack (int n, unsigned char* in, int bits, int block, float* out, float scale);
+
+#endif
@@ -55,16 +55,20 @@ CFIR create_cfir (int run, int size, float* in, float* out, int runrate, int cic
 	a->scale = 1.0 / (float)(2 * a->size);
 	a->infilt  = (float *) malloc0 (2 * a->size * sizeof (complex));
 	a->product = (float *) malloc0 (2 * a->size * sizeof (complex));
+	EnterPlanner ();
 	a->CFor = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->infilt,  (fftwf_complex *)a->product, FFTW_FORWARD,  FFTW_ESTIMATE);
 	a->CRev = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->product, (fftwf_complex *)a->out, FFTW_BACKWARD, FFTW_ESTIMATE);
+	LeavePlanner ();
 	a->mults = cfir_mults (a->size, a->runrate, a->cicrate, a->scale, a->DD, a->R, a->Pairs, a->cutoff, a->xtype, a->xbw);
 	return a;
 }
 
 void destroy_cfir (CFIR a)
 {
+	EnterPlanner ();
 	fftwf_destroy_plan (a->CRev);
 	fftwf_destroy_plan (a->CFor);
+	LeavePlanner ();
 	_aligned_free (a->mults);
 	_aligned_free (a->product);
 	_aligned_free (a->infilt);
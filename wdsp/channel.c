@@ -63,7 +63,8 @@ void pre_main_build (int channel)
 void post_main_build (int channel)
 {
 	InterlockedBitTestAndSet (&ch[channel].run, 0);
-	start_thread (channel);
+	if (!dsppool_active ())
+		start_thread (channel);
 	if (ch[channel].state == 1)
 		InterlockedBitTestAndSet (&ch[channel].exchange, 0);
 }
@@ -109,6 +110,8 @@ void pre_main_destroy (int channel)
 	InterlockedBitTestAndReset (&ch[channel].exchange, 0);
 	InterlockedBitTestAndReset (&ch[channel].run, 0);
 	ReleaseSemaphore (a->Sem_BuffReady, 1, 0);
+	if (dsppool_active ())
+		dsppool_drain (channel);
 	Sleep (25);
 }
 
@@ -50,6 +50,8 @@ struct _ch
 	float tslewdown;
 	int bfo;					// 'block_for_output', block fexchange until output is available
 	volatile long flushflag;
+	volatile long pending;		// blocks queued for the DSP worker pool, when it is enabled
+	int discard;				// queued blocks to drop after a flush, when the pool is enabled
 	struct	//io buffers
 	{
 		IOB pc, pd, pe, pf;		// copies for console calls, dsp, exchange, and flush thread
@@ -46,6 +46,7 @@ warren@wpratt.com
 #include "anf.h"
 #include "anr.h"
 #include "bandpass.h"
+#include "bfp.h"
 #include "calcc.h"
 #include "cblock.h"
 #include "cfir.h"
@@ -53,6 +54,7 @@ warren@wpratt.com
 #include "compress.h"
 #include "delay.h"
 #include "div.h"
+#include "dsppool.h"
 #include "eer.h"
 #include "emnr.h"
 #include "emph.h"
@@ -74,6 +76,7 @@ warren@wpratt.com
 #include "nobII.h"
 #include "osctrl.h"
 #include "patchpanel.h"
+#include "pfb.h"
 #include "resample.h"
 #include "RXA.h"
 #include "sender.h"
@@ -83,6 +86,7 @@ warren@wpratt.com
 #include "TXA.h"
 #include "utilities.h"
 #include "wcpAGC.h"
+#include "wfmd.h"
 
 // channel definitions
 #define MAX_CHANNELS					32					// maximum number of supported channels
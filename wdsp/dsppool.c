@@ -0,0 +1,197 @@
+/*  dsppool.c
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2015 Pavel Demin
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#include "comm.h"
+
+/********************************************************************************************************
+*																										*
+*											DSP Worker Pool												*
+*																										*
+********************************************************************************************************/
+
+// By default every channel has its own wdspmain() thread.  With the pool enabled, a fixed set of
+// workers runs the channels instead.  fexchange adds the number of new blocks to the channel's
+// 'pending' count, and only the transition from zero queues the channel, so a channel is never
+// queued twice and its blocks are processed in order.  A worker processes one block per turn and
+// re-queues the channel behind the others on its own deque, which keeps the channel on the same
+// core while that core keeps up.  A worker with an empty deque steals from the tail of the others.
+
+static dspworker pool[DSPPOOL_MAX_WORKERS];
+static int nworkers = 0;
+
+int dsppool_active (void)
+{
+	return nworkers > 0;
+}
+
+static void push (DSPWORKER w, int channel)
+{
+	EnterCriticalSection (&w->cs);
+	w->deque[(w->head + w->count++) % DSPPOOL_DEQUE] = channel;
+	LeaveCriticalSection (&w->cs);
+}
+
+static int take (DSPWORKER w)
+{
+	int channel = -1;
+	if (w->count == 0) return -1;
+	EnterCriticalSection (&w->cs);
+	if (w->count > 0)
+	{
+		channel = w->deque[w->head];
+		w->head = (w->head + 1) % DSPPOOL_DEQUE;
+		w->count--;
+	}
+	LeaveCriticalSection (&w->cs);
+	return channel;
+}
+
+static int steal (DSPWORKER w)
+{
+	int i, channel = -1;
+	DSPWORKER v;
+	for (i = 1; i < nworkers && channel < 0; i++)
+	{
+		v = &pool[(w->id + i) % nworkers];
+		if (v->count < 1) continue;
+		EnterCriticalSection (&v->cs);
+		if (v->count > 0)
+			channel = v->deque[(v->head + --v->count) % DSPPOOL_DEQUE];
+		LeaveCriticalSection (&v->cs);
+	}
+	return channel;
+}
+
+static void submit (DSPWORKER w, int channel)
+{
+	int i;
+	push (w, channel);
+	if (_InterlockedAnd (&w->idle, 1))
+		SetEvent (w->hWake);
+	else if (w->count > 1)
+	{	// the owner is busy and has a backlog; let an idle worker steal
+		for (i = 1; i < nworkers; i++)
+			if (_InterlockedAnd (&pool[(w->id + i) % nworkers].idle, 1))
+			{
+				SetEvent (pool[(w->id + i) % nworkers].hWake);
+				break;
+			}
+	}
+}
+
+static int run_block (int channel)
+{
+	int more;
+	EnterCriticalSection (&ch[channel].csDSP);
+	if (!_InterlockedAnd (&ch[channel].run, 1))
+	{
+		_InterlockedAnd (&ch[channel].pending, 0);
+		LeaveCriticalSection (&ch[channel].csDSP);
+		return 0;
+	}
+	if (ch[channel].discard > 0)
+		ch[channel].discard--;
+	else
+		xmain (channel);
+	more = InterlockedDecrement (&ch[channel].pending) > 0;
+	LeaveCriticalSection (&ch[channel].csDSP);
+	return more;
+}
+
+void __cdecl dsppool_worker (void *arg)
+{
+	DSPWORKER w = (DSPWORKER)arg;
+	int channel;
+	while (1)
+	{
+		if ((channel = take (w)) < 0 && (channel = steal (w)) < 0)
+		{
+			// announce the sleep before the last look, so that a submit either is
+			// seen here or sees 'idle' and sets the event
+			InterlockedBitTestAndSet (&w->idle, 0);
+			if ((channel = take (w)) < 0 && (channel = steal (w)) < 0)
+			{
+				WaitForSingleObject (w->hWake, INFINITE);
+				InterlockedBitTestAndReset (&w->idle, 0);
+				continue;
+			}
+			InterlockedBitTestAndReset (&w->idle, 0);
+		}
+		if (run_block (channel))
+			submit (w, channel);
+	}
+}
+
+void dsppool_queue (int channel, int n)
+{
+	if (InterlockedExchangeAdd (&ch[channel].pending, n) == 0)
+		submit (&pool[channel % nworkers], channel);
+}
+
+void dsppool_discard (int channel)
+{	// called with csDSP and csEXCH held, so 'pending' cannot change
+	ch[channel].discard = ch[channel].pending;
+}
+
+void dsppool_drain (int channel)
+{	// 'run' is already clear; the next turn of a queued channel drops its blocks
+	while (_InterlockedAnd (&ch[channel].pending, 0x7fffffff))
+		Sleep (1);
+}
+
+/********************************************************************************************************
+*																										*
+*												Properties												*
+*																										*
+********************************************************************************************************/
+
+PORT
+void SetDSPScheduler (int workers)
+{	// must be called before any channel is opened; the pool cannot be stopped again
+	int i;
+	if (nworkers > 0 || workers <= 0) return;
+	if (workers > DSPPOOL_MAX_WORKERS) workers = DSPPOOL_MAX_WORKERS;
+	for (i = 0; i < workers; i++)
+	{
+		pool[i].id = i;
+		pool[i].head = 0;
+		pool[i].count = 0;
+		pool[i].idle = 0;
+		InitializeCriticalSectionAndSpinCount (&pool[i].cs, 2500);
+#ifdef linux
+		CreateEvent (&pool[i].hWake, NULL, FALSE, FALSE, "dsppool");
+#else
+		pool[i].hWake = CreateEvent (NULL, FALSE, FALSE, TEXT("dsppool"));
+#endif
+	}
+	nworkers = workers;
+	for (i = 0; i < workers; i++)
+	{
+#ifdef linux
+		pthread_t handle = _beginthread (dsppool_worker, 0, (void *)&pool[i]);
+		SetThreadPriority (handle, THREAD_PRIORITY_HIGHEST);
+#else
+		HANDLE handle = (HANDLE) _beginthread (dsppool_worker, 0, (void *)&pool[i]);
+		SetThreadPriority (handle, THREAD_PRIORITY_HIGHEST);
+#endif
+	}
+}
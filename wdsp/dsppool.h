@@ -0,0 +1,53 @@
+/*  dsppool.h
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2015 Pavel Demin
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#ifndef _dsppool_h
+#define _dsppool_h
+
+#define DSPPOOL_MAX_WORKERS		8
+#define DSPPOOL_DEQUE			32			// at least MAX_CHANNELS; a channel is queued at most once
+
+typedef struct _dspworker
+{
+	int id;
+	int deque[DSPPOOL_DEQUE];	// channel numbers; the owner takes from 'head', thieves from 'tail'
+	int head;
+	volatile int count;
+	CRITICAL_SECTION cs;		// guards deque, head and count
+	volatile long idle;			// 1 while the worker is asleep or about to sleep
+	HANDLE hWake;				// auto-reset event, set to wake an idle worker
+	char pad[64];				// keep neighbouring workers off each other's cache lines
+} dspworker, *DSPWORKER;
+
+extern int dsppool_active (void);
+
+extern void dsppool_queue (int channel, int n);
+
+extern void dsppool_discard (int channel);
+
+extern void dsppool_drain (int channel);
+
+// Properties
+
+extern __declspec (dllexport) void SetDSPScheduler (int workers);
+
+#endif
@@ -256,8 +256,10 @@ EMNR create_emnr (int run, int position, int size, float* in, float* out, int fs
 	a->outaccum  = (float *) malloc0 (a->oasize * sizeof (float));
 	a->nsamps   = 0;
 	a->saveidx  = 0;
+	EnterPlanner ();
 	a->Rfor = fftwf_plan_dft_r2c_1d(a->fsize, a->forfftin, (fftwf_complex *)a->forfftout, FFTW_ESTIMATE);
     a->Rrev = fftwf_plan_dft_c2r_1d(a->fsize, (fftwf_complex *)a->revfftin, a->revfftout, FFTW_ESTIMATE);
+	LeavePlanner ();
 	calc_window (a);
 
 	a->g.msize = a->msize;
@@ -474,8 +476,10 @@ void destroy_emnr (EMNR a)
 	_aligned_free (a->g.lambda_d);
 	_aligned_free (a->g.lambda_y);
 
+	EnterPlanner ();
 	fftwf_destroy_plan (a->Rrev);
 	fftwf_destroy_plan (a->Rfor);
+	LeavePlanner ();
 	_aligned_free (a->outaccum);
 	for (i = 0; i < a->ovrlp; i++)
 		_aligned_free (a->save[i]);
@@ -41,15 +41,19 @@ EMPH create_emph (int run, int position, int size, float* in, float* out, int ra
 	a->infilt  = (float *) malloc0 (2 * a->size * sizeof (complex));
 	a->product = (float *) malloc0 (2 * a->size * sizeof (complex));
 	a->mults = fc_mults (a->size, a->f_low, a->f_high, - 20.0 * log10 (a->f_high / a->f_low), 0.0, ctype, a->rate, 1.0 / (2.0 * a->size), 0, 1);
+	EnterPlanner ();
 	a->CFor = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->infilt,  (fftwf_complex *)a->product, FFTW_FORWARD,  FFTW_PATIENT);
 	a->CRev = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->product, (fftwf_complex *)a->out, FFTW_BACKWARD, FFTW_PATIENT);
+	LeavePlanner ();
 	return a;
 }
 
 void destroy_emph (EMPH a)
 {
+	EnterPlanner ();
 	fftwf_destroy_plan (a->CRev);
 	fftwf_destroy_plan (a->CFor);
+	LeavePlanner ();
 	_aligned_free (a->mults);
 	_aligned_free (a->product);
 	_aligned_free (a->infilt);
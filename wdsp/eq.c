@@ -109,16 +109,20 @@ EQ create_eq (int run, int size, float *in, float *out, int nfreqs, float* F, fl
 	a->scale = 1.0 / (float)(2 * a->size);
 	a->infilt  = (float *) malloc0 (2 * a->size * sizeof (complex));
 	a->product = (float *) malloc0 (2 * a->size * sizeof (complex));
+	EnterPlanner ();
 	a->CFor = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->infilt,  (fftwf_complex *)a->product, FFTW_FORWARD,  FFTW_PATIENT);
 	a->CRev = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->product, (fftwf_complex *)a->out, FFTW_BACKWARD, FFTW_PATIENT);
+	LeavePlanner ();
 	a->mults = eq_mults (a->size, a->nfreqs, a->F, a->G, a->samplerate, a->scale, a->ctfmode, a->method);
 	return a;
 }
 
 void destroy_eq (EQ a)
 {
+	EnterPlanner ();
 	fftwf_destroy_plan (a->CRev);
 	fftwf_destroy_plan (a->CFor);
+	LeavePlanner ();
 	_aligned_free (a->mults);
 	_aligned_free (a->product);
 	_aligned_free (a->infilt);
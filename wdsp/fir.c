@@ -31,13 +31,18 @@ float* fftcv_mults (int NM, float* c_impulse)
 {
 	float* mults        = (float *) malloc0 (NM * sizeof (complex));
 	float* cfft_impulse = (float *) malloc0 (NM * sizeof (complex));
-	fftwf_plan ptmp = fftwf_plan_dft_1d(NM, (fftwf_complex *) cfft_impulse,
+	fftwf_plan ptmp;
+	EnterPlanner ();
+	ptmp = fftwf_plan_dft_1d(NM, (fftwf_complex *) cfft_impulse,
 			(fftwf_complex *) mults, FFTW_FORWARD, FFTW_PATIENT);
+	LeavePlanner ();
 	memset (cfft_impulse, 0, NM * sizeof (complex));
 	// store complex coefs right-justified in the buffer
 	memcpy (&(cfft_impulse[NM - 2]), c_impulse, (NM / 2 + 1) * sizeof(complex));
 	fftwf_execute (ptmp);
+	EnterPlanner ();
 	fftwf_destroy_plan (ptmp);
+	LeavePlanner ();
 	_aligned_free (cfft_impulse);
 	return mults;
 }
@@ -89,8 +94,11 @@ float* fir_fsamp_odd (int N, float* A, int rtype, float scale, int wintype)
 	float* window;
 	float *fcoef     = (float *) malloc0 (N * sizeof (complex));
 	float *c_impulse = (float *) malloc0 (N * sizeof (complex));
-	fftwf_plan ptmp = fftwf_plan_dft_1d(N, (fftwf_complex *)fcoef, (fftwf_complex *)c_impulse, FFTW_BACKWARD, FFTW_PATIENT);
+	fftwf_plan ptmp;
 	float local_scale = 1.0 / (float)N;
+	EnterPlanner ();
+	ptmp = fftwf_plan_dft_1d(N, (fftwf_complex *)fcoef, (fftwf_complex *)c_impulse, FFTW_BACKWARD, FFTW_PATIENT);
+	LeavePlanner ();
 	for (i = 0; i <= mid; i++)
 	{
 		mag = A[i] * local_scale;
@@ -104,7 +112,9 @@ float* fir_fsamp_odd (int N, float* A, int rtype, float scale, int wintype)
 		fcoef[2 * i + 1] = - fcoef[2 * (mid - j) + 1];
 	}
 	fftwf_execute (ptmp);
+	EnterPlanner ();
 	fftwf_destroy_plan (ptmp);
+	LeavePlanner ();
 	_aligned_free (fcoef);
 	window = get_fsamp_window(N, wintype);
 	switch (rtype)
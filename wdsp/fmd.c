@@ -64,16 +64,20 @@ FMD create_fmd( int run, int size, float* in, float* out, int rate, float deviat
 	a->infilt  = (float *) malloc0 (2 * a->size * sizeof (complex));
 	a->product = (float *) malloc0 (2 * a->size * sizeof (complex));
 	a->outfilt = (float *) malloc0 (2 * a->size * sizeof (complex));
+	EnterPlanner ();
 	a->CFor = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->infilt,  (fftwf_complex *)a->product, FFTW_FORWARD,  FFTW_PATIENT);
 	a->CRev = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->product, (fftwf_complex *)a->outfilt,  FFTW_BACKWARD, FFTW_PATIENT);
+	LeavePlanner ();
 	// audio filter
 	a->afgain = afgain;
 	impulse = fir_bandpass (a->size + 1, 0.8 * a->f_low, 1.1 * a->f_high, a->rate, 0, 1, a->afgain / (2.0 * a->size));
 	a->amults = fftcv_mults (2 * a->size, impulse);
 	a->ainfilt  = (float *) malloc0 (2 * a->size * sizeof (complex));
 	a->aproduct = (float *) malloc0 (2 * a->size * sizeof (complex));
+	EnterPlanner ();
 	a->aCFor = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->ainfilt,  (fftwf_complex *)a->aproduct, FFTW_FORWARD,  FFTW_PATIENT);
 	a->aCRev = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->aproduct, (fftwf_complex *)a->out,      FFTW_BACKWARD, FFTW_PATIENT);
+	LeavePlanner ();
 	_aligned_free (impulse);
 	// CTCSS Removal
 	a->sntch_run = sntch_run;
@@ -85,13 +89,17 @@ FMD create_fmd( int run, int size, float* in, float* out, int rate, float deviat
 void destroy_fmd (FMD a)
 {
 	destroy_snotch (a->sntch);
+	EnterPlanner ();
 	fftwf_destroy_plan (a->aCRev);
 	fftwf_destroy_plan (a->aCFor);
+	LeavePlanner ();
 	_aligned_free (a->aproduct);
 	_aligned_free (a->ainfilt);
 	_aligned_free (a->amults);
+	EnterPlanner ();
 	fftwf_destroy_plan (a->CRev);
 	fftwf_destroy_plan (a->CFor);
+	LeavePlanner ();
 	_aligned_free (a->outfilt);
 	_aligned_free (a->product);
 	_aligned_free (a->infilt);
@@ -56,16 +56,20 @@ FMMOD create_fmmod (int run, int size, float* in, float* out, int rate, float de
 	a->bp_mults = fftcv_mults (2 * a->size, impulse);
 	a->bp_infilt  = (float *) malloc0 (2 * a->size * sizeof (complex));
 	a->bp_product = (float *) malloc0 (2 * a->size * sizeof (complex));
+	EnterPlanner ();
 	a->bp_CFor = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->bp_infilt,  (fftwf_complex *)a->bp_product, FFTW_FORWARD,  FFTW_PATIENT);
 	a->bp_CRev = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->bp_product, (fftwf_complex *)a->out, FFTW_BACKWARD, FFTW_PATIENT);
+	LeavePlanner ();
 	_aligned_free (impulse);
 	return a;
 }
 
 void destroy_fmmod (FMMOD a)
 {
+	EnterPlanner ();
 	fftwf_destroy_plan (a->bp_CRev);
 	fftwf_destroy_plan (a->bp_CFor);
+	LeavePlanner ();
 	_aligned_free (a->bp_product);
 	_aligned_free (a->bp_infilt);
 	_aligned_free (a->bp_mults);
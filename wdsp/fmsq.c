@@ -52,8 +52,10 @@ FMSQ create_fmsq (int run, int size, float* insig, float* outsig, float* trigger
 	a->G[2] = 3.0;
 	a->G[3] = + 20.0 * log10 (20000.0 / a->pllpole);
 	a->mults = eq_mults (a->size, 3, a->F, a->G, a->rate, 1.0 / (2.0 * a->size), 0, 1);
+	EnterPlanner ();
 	a->CFor = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->infilt,  (fftwf_complex *)a->product, FFTW_FORWARD,  FFTW_PATIENT);
 	a->CRev = fftwf_plan_dft_1d(2 * a->size, (fftwf_complex *)a->product, (fftwf_complex *)a->noise,   FFTW_BACKWARD, FFTW_PATIENT);
+	LeavePlanner ();
 	// noise averaging
 	a->avtau = avtau;
 	a->avm = exp (-1.0 / (a->rate * a->avtau));
@@ -101,8 +103,10 @@ void destroy_fmsq (FMSQ a)
 {
 	_aligned_free (a->cdown);
 	_aligned_free (a->cup);
+	EnterPlanner ();
 	fftwf_destroy_plan (a->CRev);
 	fftwf_destroy_plan (a->CFor);
+	LeavePlanner ();
 	_aligned_free (a->mults);
 	_aligned_free (a->noise);
 	_aligned_free (a->product);
@@ -227,4 +231,12 @@ void SetRXAFMSQThreshold (int channel, float threshold)
 	rxa[channel].fmsq.p->tail_thresh = threshold;
 	rxa[channel].fmsq.p->unmute_thresh = 0.9 * threshold;
 	LeaveCriticalSection (&ch[channel].csDSP);
+}
+
+PORT
+int GetRXAFMSQMuted (int channel)
+{
+	// no csDSP here, it is held for a whole DSP buffer and the state is a single int
+	FMSQ a = rxa[channel].fmsq.p;
+	return a->run && a->state == MUTED;
 }
\ No newline at end of file
@@ -81,6 +81,10 @@ extern void xfmsq (FMSQ a);
 
 // RXA Properties
 
+extern __declspec (dllexport) void SetRXAFMSQRun (int channel, int run);
+
 extern __declspec (dllexport) void SetRXAFMSQThreshold (int channel, float threshold);
 
+extern __declspec (dllexport) int GetRXAFMSQMuted (int channel);
+
 #endif
\ No newline at end of file
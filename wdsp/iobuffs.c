@@ -411,7 +411,6 @@ void create_iobuffs (int channel)
 	a->r2_havesamps = (DSP_MULT - 1) * a->r2_size;
 	n = a->r2_havesamps / a->out_size;
 	a->r2_unqueuedsamps = a->r2_havesamps - n * a->out_size;
-	InitializeCriticalSectionAndSpinCount(&a->r2_ControlSection, 2500);
 #ifdef linux
 	CreateSemaphore(&a->Sem_BuffReady, 0, 0, 1000, 0);
 	CreateSemaphore(&a->Sem_OutReady, 0, n, 1000, 0);
@@ -429,7 +428,6 @@ void destroy_iobuffs (int channel)
 	destroy_slews (a);
 	CloseHandle (a->Sem_OutReady);
 	CloseHandle (a->Sem_BuffReady);
-	DeleteCriticalSection(&a->r2_ControlSection);
 	_aligned_free (a->r2_baseptr);
 	_aligned_free (a->r1_baseptr);
 	_aligned_free (a);
@@ -447,7 +445,10 @@ void flush_iobuffs (int channel)
 	a->r2_inidx = (DSP_MULT - 1) * a->r2_size;
 	a->r2_outidx = 0;
 	a->r2_havesamps = (DSP_MULT - 1) * a->r2_size;
-	while (!WaitForSingleObject (a->Sem_BuffReady, 1));
+	if (dsppool_active ())
+		dsppool_discard (channel);
+	else
+		while (!WaitForSingleObject (a->Sem_BuffReady, 1));
 	n = a->r2_havesamps / a->out_size;
 	a->r2_unqueuedsamps = a->r2_havesamps - n * a->out_size;
 	CloseHandle (a->Sem_OutReady);
@@ -465,6 +466,7 @@ void fexchange0 (int channel, float* in, float* out, int* error)
 {
 	int n;
 	int doit = 0;
+	LONG have, left;
 	IOB a;
 	*error = 0;
 	if (_InterlockedAnd (&ch[channel].exchange, 1))
@@ -479,17 +481,23 @@ void fexchange0 (int channel, float* in, float* out, int* error)
 		if ((a->r1_unqueuedsamps += a->in_size) >= a->r1_outsize)
 		{
 			n = a->r1_unqueuedsamps / a->r1_outsize;
-			ReleaseSemaphore(a->Sem_BuffReady, n, 0);
+			if (dsppool_active ())
+				dsppool_queue (channel, n);
+			else
+				ReleaseSemaphore(a->Sem_BuffReady, n, 0);
 			a->r1_unqueuedsamps -= n * a->r1_outsize;
 		}
 		if ((a->r1_inidx += a->in_size) == a->r1_active_buffsize)
 			a->r1_inidx = 0;
 
-		EnterCriticalSection (&a->r2_ControlSection);
-		if (a->r2_havesamps >= a->out_size)
+		do
+		{
+			have = a->r2_havesamps;
+			left = have - a->out_size;
+			if (left < 0) left = 0;
+		} while (InterlockedCompareExchange (&a->r2_havesamps, left, have) != have);
+		if (have >= a->out_size)
 			doit = 1;
-		if ((a->r2_havesamps -= a->out_size) < 0) a->r2_havesamps = 0;
-		LeaveCriticalSection (&a->r2_ControlSection);
 		if (a->bfo) WaitForSingleObject (a->Sem_OutReady, INFINITE);
 		if (a->bfo || doit)
 			if (_InterlockedAnd (&a->slew.downflag, 1))
@@ -507,6 +515,7 @@ void fexchange0 (int channel, float* in, float* out, int* error)
 		{
 			memset (out, 0, a->out_size * sizeof (complex));
 			*error += -2;
+			InterlockedIncrement (&a->dropouts);
 		}
 		if ((a->r2_outidx += a->out_size) == a->r2_active_buffsize)
 			a->r2_outidx = 0;
@@ -519,6 +528,7 @@ void fexchange2 (int channel, INREAL *Iin, INREAL *Qin, OUTREAL *Iout, OUTREAL *
 {
 	int i, n;
 	int doit = 0;
+	LONG have, left;
 	IOB a;
 	*error = 0;
 	if (_InterlockedAnd (&ch[channel].exchange, 1))
@@ -537,17 +547,23 @@ void fexchange2 (int channel, INREAL *Iin, INREAL *Qin, OUTREAL *Iout, OUTREAL *
 		if ((a->r1_unqueuedsamps += a->in_size) >= a->r1_outsize)
 		{
 			n = a->r1_unqueuedsamps / a->r1_outsize;
-			ReleaseSemaphore(a->Sem_BuffReady, n, 0);	
+			if (dsppool_active ())
+				dsppool_queue (channel, n);
+			else
+				ReleaseSemaphore(a->Sem_BuffReady, n, 0);
 			a->r1_unqueuedsamps -= n * a->r1_outsize;
 		}
 		if ((a->r1_inidx += a->in_size) == a->r1_active_buffsize)
 			a->r1_inidx = 0;
 
-		EnterCriticalSection (&a->r2_ControlSection);
-		if (a->r2_havesamps >= a->out_size)
+		do
+		{
+			have = a->r2_havesamps;
+			left = have - a->out_size;
+			if (left < 0) left = 0;
+		} while (InterlockedCompareExchange (&a->r2_havesamps, left, have) != have);
+		if (have >= a->out_size)
 			doit = 1;
-		if ((a->r2_havesamps -= a->out_size) < 0) a->r2_havesamps = 0;
-		LeaveCriticalSection (&a->r2_ControlSection);
 		if (a->bfo) WaitForSingleObject (a->Sem_OutReady, INFINITE);
 		if (a->bfo || doit)
 		{
@@ -572,6 +588,7 @@ void fexchange2 (int channel, INREAL *Iin, INREAL *Qin, OUTREAL *Iout, OUTREAL *
 			memset (Iout, 0, a->out_size * sizeof (OUTREAL));
 			memset (Qout, 0, a->out_size * sizeof (OUTREAL));
 			*error += -2;
+			InterlockedIncrement (&a->dropouts);
 		}
 		if ((a->r2_outidx += a->out_size) == a->r2_active_buffsize)
 			a->r2_outidx = 0;
@@ -583,12 +600,10 @@ void dexchange (int channel, float* in, float* out)
 {
 	int n;
 	IOB a = ch[channel].iob.pd;
-	if (!_InterlockedAnd (&ch[channel].run, 1)) _endthread();
 
-	EnterCriticalSection (&a->r2_ControlSection);
-	a->r2_havesamps += a->r2_insize;
-	LeaveCriticalSection (&a->r2_ControlSection);
 	memcpy (a->r2_baseptr + 2 * a->r2_inidx, in, a->r2_insize * sizeof (complex));
+	// publish the samples only once they are in the ring; the atomic add is a full barrier
+	InterlockedExchangeAdd (&a->r2_havesamps, a->r2_insize);
 	if ((a->r2_inidx += a->r2_insize) == a->r2_active_buffsize)
 		a->r2_inidx = 0;
 	if (a->bfo && (a->r2_unqueuedsamps += a->r2_insize) >= a->out_size)
@@ -601,3 +616,9 @@ void dexchange (int channel, float* in, float* out)
 	if ((a->r1_outidx += a->r1_outsize) == a->r1_active_buffsize)
 		a->r1_outidx = 0;
 }
+
+PORT
+int GetChannelDropouts (int channel)
+{
+	return (int)ch[channel].iob.pe->dropouts;
+}
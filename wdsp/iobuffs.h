@@ -27,6 +27,8 @@ warren@wpratt.com
 #ifndef _iobuffs_h
 #define _iobuffs_h
 #include "comm.h"
+#define IOB_CACHE_LINE	64
+
 typedef struct _iob
 {
 	int   channel;
@@ -40,20 +42,30 @@ typedef struct _iob
 	int   r2_active_buffsize;					// size of output pseudo-ring (in complex samples)
 	
 	float* r1_baseptr;							// pointer to input pseudo-ring
+	float* r2_baseptr;							// pointer to output pseudo-ring
+
+	// The I/O thread (fexchange) and the DSP thread (dexchange) each own one group of indices,
+	// and the groups sit on separate cache lines.  The only shared count, r2_havesamps, is
+	// updated atomically, so dexchange takes no lock.  This is not a lock-free handoff:
+	// fexchange still holds csEXCH, which excludes the channel setters and flushes rather than
+	// the DSP thread, Sem_BuffReady still wakes the DSP thread for every block and fexchange
+	// still waits on Sem_OutReady when bfo is set.
+	char  pad0[IOB_CACHE_LINE];
 	int   r1_inidx;								// in 'float', actual index into the buffer is 2 times this
-	int   r1_outidx;							// in 'float', actual index into the buffer is 2 times this
 	int   r1_unqueuedsamps;						// number of input samples not yet queued/released for execution
-
-	float* r2_baseptr;							// pointer to output pseudo-ring
-	int   r2_inidx;								// in 'float', actual index into the buffer is 2 times this
 	int   r2_outidx;							// in 'float', actual index into the buffer is 2 times this
-	int   r2_havesamps;							// number of processed samples in output pseudo-ring
+	char  pad1[IOB_CACHE_LINE];
+	int   r1_outidx;							// in 'float', actual index into the buffer is 2 times this
+	int   r2_inidx;								// in 'float', actual index into the buffer is 2 times this
 	int   r2_unqueuedsamps;						// number of output samples not yet queued / released for output
-	CRITICAL_SECTION r2_ControlSection;
+	char  pad2[IOB_CACHE_LINE];
+	volatile LONG r2_havesamps;					// number of processed samples in output pseudo-ring
+	char  pad3[IOB_CACHE_LINE];
 
 	int bfo;									// block_for_output, wait until output is available before proceeding
 	HANDLE Sem_OutReady;						// count = number of 'out_size' buffers processed and available for output
 	HANDLE Sem_BuffReady;						// count = number of 'dsp_size' buffers queued for processing
+	volatile long dropouts;						// number of output blocks zero-filled because no processed samples were ready
 
 	struct
 	{
@@ -93,4 +105,6 @@ extern void fexchange2 (int channel, INREAL *Iin, INREAL *Qin, OUTREAL *Iout, OU
 
 extern void dexchange (int channel, float* in, float* out);
 
+extern __declspec (dllexport) int GetChannelDropouts (int channel);
+
 #endif
\ No newline at end of file
@@ -26,6 +26,11 @@ john.d.melton@googlemail.com
 */
 
 #include "comm.h"
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 /********************************************************************************************************
 *													*
@@ -35,77 +40,320 @@ john.d.melton@googlemail.com
 
 #ifdef linux
 
-void QueueUserWorkItem(void *function,void *context,int flags) {
+/********************************************************************************************************
+*													*
+*	Worker Pool											*
+*													*
+********************************************************************************************************/
+
+// QueueUserWorkItem() hands jobs to a fixed set of threads that are started once and then
+// live for the life of the process.  Jobs travel through a bounded lock-free ring (one
+// sequence number per slot); idle workers spin briefly and then sleep on a semaphore that
+// is only posted when somebody is actually sleeping, so a busy pool makes no system calls.
+
+#define POOL_SIZE	256		// ring slots, must be a power of two
+#define POOL_SPIN	200		// empty polls before a worker goes to sleep
+
+typedef struct _pooljob
+{
+	volatile long seq;
+	DWORD (*function)(void *);
+	void *context;
+} pooljob;
+
+static struct
+{
+	pooljob job[POOL_SIZE];
+	volatile long head __attribute__((aligned(64)));
+	volatile long tail __attribute__((aligned(64)));
+	volatile long sleeping __attribute__((aligned(64)));
+	sem_t wakeup;
+	int workers;
+} pool;
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+static int pool_push (DWORD (*function)(void *), void *context)
+{
+	pooljob *j;
+	long pos = pool.head;
+	long dif;
+	for (;;)
+	{
+		j = &pool.job[pos & (POOL_SIZE - 1)];
+		dif = j->seq - pos;
+		if (dif == 0)
+		{
+			if (__sync_bool_compare_and_swap (&pool.head, pos, pos + 1)) break;
+			pos = pool.head;
+		}
+		else if (dif < 0)
+			return 0;
+		else
+			pos = pool.head;
+	}
+	j->function = function;
+	j->context = context;
+	__sync_synchronize ();
+	j->seq = pos + 1;
+	return 1;
+}
+
+static int pool_pop (DWORD (**function)(void *), void **context)
+{
+	pooljob *j;
+	long pos = pool.tail;
+	long dif;
+	for (;;)
+	{
+		j = &pool.job[pos & (POOL_SIZE - 1)];
+		dif = j->seq - (pos + 1);
+		if (dif == 0)
+		{
+			if (__sync_bool_compare_and_swap (&pool.tail, pos, pos + 1)) break;
+			pos = pool.tail;
+		}
+		else if (dif < 0)
+			return 0;
+		else
+			pos = pool.tail;
+	}
+	__sync_synchronize ();
+	*function = j->function;
+	*context = j->context;
+	__sync_synchronize ();
+	j->seq = pos + POOL_SIZE;
+	return 1;
+}
+
+static void *pool_worker (void *arg)
+{
+	DWORD (*function)(void *);
+	void *context;
+	int spin = 0;
+	for (;;)
+	{
+		if (pool_pop (&function, &context))
+		{
+			function (context);
+			spin = 0;
+		}
+		else if (++spin < POOL_SPIN)
+			sched_yield ();
+		else
+		{
+			// announce the sleep before the last look, so a concurrent push either
+			// lands in that look or sees 'sleeping' and posts the semaphore
+			__sync_add_and_fetch (&pool.sleeping, 1);
+			if (pool_pop (&function, &context))
+			{
+				__sync_sub_and_fetch (&pool.sleeping, 1);
+				function (context);
+			}
+			else
+			{
+				while (sem_wait (&pool.wakeup) != 0);
+				__sync_sub_and_fetch (&pool.sleeping, 1);
+			}
+			spin = 0;
+		}
+	}
+	return 0;
+}
+
+static void pool_start (void)
+{
+	int i;
 	pthread_t t;
-	pthread_create(&t, NULL, function, context);
-	pthread_join(t, NULL);
+	long cpus = sysconf (_SC_NPROCESSORS_ONLN);
+	for (i = 0; i < POOL_SIZE; i++)
+		pool.job[i].seq = i;
+	pool.head = pool.tail = pool.sleeping = 0;
+	sem_init (&pool.wakeup, 0, 0);
+	pool.workers = 0;
+	for (i = 0; i < (cpus > 1 ? cpus : 1); i++)
+		if (pthread_create (&t, NULL, pool_worker, 0) == 0)
+		{
+			pthread_detach (t);
+			pool.workers++;
+		}
+}
+
+void QueueUserWorkItem(void *function,void *context,int flags) {
+	pthread_once(&pool_once, pool_start);
+	// with no workers, or with the ring full, the caller runs the job itself
+	if(pool.workers==0 || !pool_push((DWORD (*)(void *))function, context)) {
+		((DWORD (*)(void *))function)(context);
+		return;
+	}
+	__sync_synchronize();
+	if(pool.sleeping>0) sem_post(&pool.wakeup);
 }
 
-void InitializeCriticalSectionAndSpinCount(pthread_mutex_t *mutex,int count) {
-	pthread_mutexattr_t mAttr;
-        pthread_mutexattr_init(&mAttr);
-	pthread_mutexattr_settype(&mAttr,PTHREAD_MUTEX_RECURSIVE_NP);
-	pthread_mutex_init(mutex,&mAttr);
-	pthread_mutexattr_destroy(&mAttr);
-	// ignore count
+/********************************************************************************************************
+*													*
+*	Synchronization											*
+*													*
+********************************************************************************************************/
+
+// Critical sections, semaphores and events are built directly on futexes.  Uncontended
+// operations are a single atomic instruction; contended ones spin for a while on
+// multi-core machines before the thread is put to sleep in the kernel.
+
+#define SYNC_SPIN	100		// polls of a semaphore or event before sleeping
+
+static int sync_cpus = 0;
+
+static __forceinline void cpu_relax (void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+	__asm__ __volatile__ ("pause");
+#elif defined(__arm__) || defined(__aarch64__)
+	__asm__ __volatile__ ("yield");
+#else
+	__sync_synchronize ();
+#endif
 }
 
-void EnterCriticalSection(pthread_mutex_t *mutex) {
-	pthread_mutex_lock(mutex);
+static int spin_allowed (void)
+{
+	if (sync_cpus == 0)
+		sync_cpus = (int)sysconf (_SC_NPROCESSORS_ONLN);
+	return sync_cpus > 1;
 }
 
-void LeaveCriticalSection(pthread_mutex_t *mutex) {
-	pthread_mutex_unlock(mutex);
+static __forceinline int futex_wait (volatile int *addr, int val, const struct timespec *timeout)
+{
+	return syscall (SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, timeout, 0, 0);
 }
 
-void DeleteCriticalSection(pthread_mutex_t *mutex) {
-	pthread_mutex_destroy(mutex);
+static __forceinline int futex_wake (volatile int *addr, int n)
+{
+	return syscall (SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, 0, 0, 0);
 }
 
-int LinuxWaitForSingleObject(sem_t *sem,int ms) {
-	int result=0;
-	if(ms==INFINITE) {
-		// wait for the lock
-		result=sem_wait(sem);
-	} else {
-		// try to get the lock
-		result=sem_trywait(sem);
-		if(result!=0) {
-			// didn't get the lock
-			if(ms!=0) {
-				// sleep if ms not zero
-				sleep(ms);
-				// try to get the lock again
-				result=sem_trywait(sem);
-			}
+void InitializeCriticalSectionAndSpinCount(CRITICAL_SECTION *cs,int count) {
+	cs->lock=0;
+	cs->owner=0;
+	cs->recursion=0;
+	cs->spin=spin_allowed()?count:0;
+}
+
+void EnterCriticalSection(CRITICAL_SECTION *cs) {
+	pthread_t self=pthread_self();
+	int i, c;
+	// wdsp re-enters some sections from the thread that holds them
+	if(cs->lock!=0 && pthread_equal(cs->owner,self)) {
+		cs->recursion++;
+		return;
+	}
+	if(!__sync_bool_compare_and_swap(&cs->lock,0,1)) {
+		for(i=0;i<cs->spin;i++) {
+			cpu_relax();
+			if(cs->lock==0 && __sync_bool_compare_and_swap(&cs->lock,0,1)) goto acquired;
 		}
+		// mark the lock contended, so the holder knows to wake somebody
+		while((c=__sync_lock_test_and_set(&cs->lock,2))!=0)
+			futex_wait(&cs->lock,2,0);
+	}
+acquired:
+	cs->owner=self;
+	cs->recursion=1;
+}
+
+void LeaveCriticalSection(CRITICAL_SECTION *cs) {
+	if(--cs->recursion>0) return;
+	cs->owner=0;
+	if(__sync_fetch_and_sub(&cs->lock,1)!=1) {
+		cs->lock=0;
+		__sync_synchronize();
+		futex_wake(&cs->lock,1);
 	}
-	
-	return result;
 }
 
-int CreateSemaphore(sem_t* sem,int attributes,int initial_count,int maximum_count) {
-	int result;
-	result=sem_init(sem, 0, 0);
-	return result;
+void DeleteCriticalSection(CRITICAL_SECTION *cs) {
 }
 
-void LinuxReleaseSemaphore(sem_t* sem,int release_count, int* previous_count) {
-	while(release_count>0) {
-		sem_post(sem);
-		release_count--;
+static __forceinline int sync_take(HANDLE *sem) {
+	int c;
+	while((c=sem->count)>0)
+		if(__sync_bool_compare_and_swap(&sem->count,c,c-1)) return 1;
+	return 0;
+}
+
+static void sync_give(HANDLE *sem,int n) {
+	int c;
+	// as on Windows, a release that would pass the maximum count is refused
+	do {
+		c=sem->count;
+		if(c+n>sem->maximum) return;
+	} while(!__sync_bool_compare_and_swap(&sem->count,c,c+n));
+	if(sem->waiters) futex_wake(&sem->count,n);
+}
+
+int LinuxWaitForSingleObject(HANDLE *sem,int ms) {
+	struct timespec deadline, now, timeout;
+	int i;
+	if(sync_take(sem)) return 0;
+	if(ms==0) return -1;
+	if(spin_allowed()) {
+		for(i=0;i<SYNC_SPIN;i++) {
+			cpu_relax();
+			if(sem->count>0 && sync_take(sem)) return 0;
+		}
+	}
+	if(ms!=INFINITE) {
+		clock_gettime(CLOCK_MONOTONIC,&deadline);
+		deadline.tv_sec+=ms/1000;
+		deadline.tv_nsec+=(ms%1000)*1000000L;
+		if(deadline.tv_nsec>=1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec-=1000000000L;
+		}
 	}
+	__sync_add_and_fetch(&sem->waiters,1);
+	while(!sync_take(sem)) {
+		if(ms==INFINITE) {
+			futex_wait(&sem->count,0,0);
+		} else {
+			clock_gettime(CLOCK_MONOTONIC,&now);
+			timeout.tv_sec=deadline.tv_sec-now.tv_sec;
+			timeout.tv_nsec=deadline.tv_nsec-now.tv_nsec;
+			if(timeout.tv_nsec<0) {
+				timeout.tv_sec--;
+				timeout.tv_nsec+=1000000000L;
+			}
+			if(timeout.tv_sec<0) {
+				__sync_sub_and_fetch(&sem->waiters,1);
+				return -1;
+			}
+			futex_wait(&sem->count,0,&timeout);
+		}
+	}
+	__sync_sub_and_fetch(&sem->waiters,1);
+	return 0;
+}
+
+int CreateSemaphore(HANDLE *sem,int attributes,int initial_count,int maximum_count,char* name) {
+	sem->count=initial_count;
+	sem->waiters=0;
+	sem->maximum=maximum_count;
+	return 0;
+}
+
+void LinuxReleaseSemaphore(HANDLE *sem,int release_count, int* previous_count) {
+	if(previous_count) *previous_count=sem->count;
+	sync_give(sem,release_count);
 }
 
-int CreateEvent(sem_t* sem,void* security_attributes,int bManualReset,int bInitialState,char* name) {
-	int result;
-	result=CreateSemaphore(sem,0,0,0);
-	// need to handle bManualReset and bInitialState
-	return result;
+int CreateEvent(HANDLE *sem,void* security_attributes,int bManualReset,int bInitialState,char* name) {
+	// only auto-reset events are used: a wait consumes the signal, and setting an
+	// event that is already signalled does nothing
+	return CreateSemaphore(sem,0,bInitialState?1:0,1,0);
 }
 
-void LinuxSetEvent(sem_t* sem) {
-	sem_post(sem);
+void LinuxSetEvent(HANDLE* sem) {
+	sync_give(sem,1);
 }
 
 pthread_t _beginthread( void( __cdecl *start_address )( void * ), unsigned stack_size, void *arglist) {
@@ -153,7 +401,7 @@ int CloseHandle(HANDLE hObject) {
 void Sleep(int ms) {
 	struct timespec timeOut,remains;
 	timeOut.tv_sec = ms/1000;
-	timeOut.tv_nsec = (ms%1000)*10000000;
+	timeOut.tv_nsec = (ms%1000)*1000000;
 	nanosleep(&timeOut, &remains);
 }
 
@@ -25,16 +25,36 @@ john.d.melton@googlemail.com
 
 */
 
+#ifndef _linux_port_h
+#define _linux_port_h
+
 #ifdef linux
 
 #include <pthread.h>
 #include <semaphore.h>
 #include <stdint.h>
 
-#define CRITICAL_SECTION pthread_mutex_t
+// futex-backed replacements for the Win32 synchronization objects
+
+typedef struct _linux_cs
+{
+	volatile int lock;			// 0 = free, 1 = held, 2 = held with sleepers
+	volatile pthread_t owner;
+	int recursion;
+	int spin;
+} linux_cs;
+
+typedef struct _linux_sync
+{
+	volatile int count;			// semaphore count; 0 or 1 for an event
+	volatile int waiters;
+	int maximum;
+} linux_sync;
+
+#define CRITICAL_SECTION linux_cs
 #define LONG long
 #define DWORD long
-#define HANDLE sem_t
+#define HANDLE linux_sync
 #define WINAPI
 #define FALSE 0
 #define InterlockedIncrement(base) __sync_add_and_fetch(base,1)
@@ -42,6 +62,9 @@ john.d.melton@googlemail.com
 #define InterlockedBitTestAndSet(base,bit) __sync_or_and_fetch(base,1<<bit)
 #define InterlockedBitTestAndReset(base,bit) __sync_and_and_fetch(base,~(1<<bit))
 #define _InterlockedAnd(base,mask) __sync_fetch_and_and(base,mask)
+#define InterlockedExchangeAdd(base,value) __sync_fetch_and_add(base,value)
+#define InterlockedCompareExchange(base,exchange,comparand) __sync_val_compare_and_swap(base,comparand,exchange)
+#define MemoryBarrier() __sync_synchronize()
 #define __declspec(x)
 #define __cdecl
 #define __forceinline
@@ -61,21 +84,23 @@ john.d.melton@googlemail.com
 
 void QueueUserWorkItem(void *function,void *context,int flags);
 
-void InitializeCriticalSectionAndSpinCount(pthread_mutex_t *mutex,int count);
+void InitializeCriticalSectionAndSpinCount(CRITICAL_SECTION *cs,int count);
+
+void EnterCriticalSection(CRITICAL_SECTION *cs);
 
-void EnterCritiaclSection(pthread_mutex_t *mutex);
+void LeaveCriticalSection(CRITICAL_SECTION *cs);
 
-void LeaveCritiaclSection(pthread_mutex_t *mutex);
+void DeleteCriticalSection(CRITICAL_SECTION *cs);
 
-void DeleteCriticalSection(pthread_mutex_t *mutex);
+int LinuxWaitForSingleObject(HANDLE *sem,int ms);
 
-int LinuxWaitForSingleObject(sem_t *sem,int x);
+int CreateSemaphore(HANDLE *sem,int attributes,int initial_count,int maximum_count,char* name);
 
-void LinuxReleaseSemaphore(sem_t *sem,int release_count, int* previous_count);
+void LinuxReleaseSemaphore(HANDLE *sem,int release_count, int* previous_count);
 
-int CreateEvent(sem_t *sem,void* security_attributes,int bManualReset,int bInitialState,char* name);
+int CreateEvent(HANDLE *sem,void* security_attributes,int bManualReset,int bInitialState,char* name);
 
-void LinuxSetEvent(sem_t* sem);
+void LinuxSetEvent(HANDLE* sem);
 
 pthread_t _beginthread( void( __cdecl *start_address )( void * ), unsigned stack_size, void *arglist);
 
@@ -88,3 +113,4 @@ int CloseHandle(HANDLE hObject);
 void Sleep(int ms);
 #endif
 
+#endif
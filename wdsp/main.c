@@ -39,6 +39,7 @@ void main (void *pargs)
 		while (_InterlockedAnd (&ch[channel].run, 1))
 		{
 			WaitForSingleObject(ch[channel].iob.pd->Sem_BuffReady,INFINITE);
+			if (!_InterlockedAnd (&ch[channel].run, 1)) break;
 			EnterCriticalSection (&ch[channel].csDSP);
 			dexchange (channel, rxa[channel].outbuff, rxa[channel].inbuff);
 			xrxa (channel);
@@ -49,6 +50,7 @@ void main (void *pargs)
 		while (_InterlockedAnd (&ch[channel].run, 1))
 		{
 			WaitForSingleObject(ch[channel].iob.pd->Sem_BuffReady,INFINITE);
+			if (!_InterlockedAnd (&ch[channel].run, 1)) break;
 			EnterCriticalSection (&ch[channel].csDSP);
 			dexchange (channel, txa[channel].outbuff, txa[channel].inbuff);
 			xtxa (channel);
@@ -112,3 +114,21 @@ void flush_main (int channel)
 		break;
 	}
 }
+
+void xmain (int channel)
+{	// one block, for the DSP worker pool; the caller holds csDSP
+	switch (ch[channel].type)
+	{
+	case 0:
+		dexchange (channel, rxa[channel].outbuff, rxa[channel].inbuff);
+		xrxa (channel);
+		break;
+	case 1:
+		dexchange (channel, txa[channel].outbuff, txa[channel].inbuff);
+		xtxa (channel);
+		break;
+	case 31:
+
+		break;
+	}
+}
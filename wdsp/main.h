@@ -39,4 +39,6 @@ extern void destroy_main (int channel);
 
 extern void flush_main (int channel);
 
+extern void xmain (int channel);
+
 #endif
@@ -26,7 +26,7 @@ warren@wpratt.com
 
 #include "comm.h"
 
-METER create_meter (int run, int* prun, int size, float* buff, int rate, float tau_av, float tau_decay, float* result, CRITICAL_SECTION** pmtupdate, int enum_av, int enum_pk, int enum_gain, float* pgain)
+METER create_meter (int run, int* prun, int size, float* buff, int rate, float tau_av, float tau_decay, float* result, volatile long* pmtseq, int enum_av, int enum_pk, int enum_gain, float* pgain)
 {
 	METER a = (METER) malloc0 (sizeof (meter));
 	a->run = run;
@@ -43,17 +43,13 @@ METER create_meter (int run, int* prun, int size, float* buff, int rate, float t
 	a->pgain = pgain;
 	a->mult_average = exp (-1.0 / (a->rate * a->tau_average));
 	a->mult_peak = exp (-1.0 / (a->rate * a->tau_peak_decay));
-	InitializeCriticalSectionAndSpinCount (&a->mtupdate, 2500);
-	pmtupdate[enum_av]   = &a->mtupdate;
-	pmtupdate[enum_pk]   = &a->mtupdate;
-	pmtupdate[enum_gain] = &a->mtupdate;
+	a->pmtseq = pmtseq;
 	flush_meter (a);
 	return a;
 }
 
 void destroy_meter (METER a)
 {
-	DeleteCriticalSection (&a->mtupdate);
 	_aligned_free (a);
 }
 
@@ -61,16 +57,17 @@ void flush_meter (METER a)
 {
 	a->avg = -400.0;
 	a->peak = 0.0;
+	InterlockedIncrement (a->pmtseq);
 	a->result[a->enum_av] = -400.0;
 	a->result[a->enum_pk] = -400.0;
 	if ((a->pgain != 0) && (a->enum_gain >= 0))
 		a->result[a->enum_gain] = -400.0;
+	InterlockedIncrement (a->pmtseq);
 }
 
 void xmeter (METER a)
 {
 	int srun;
-	EnterCriticalSection (&a->mtupdate);
 	if (a->prun != 0)
 		srun = *(a->prun);
 	else
@@ -88,18 +85,43 @@ void xmeter (METER a)
 			if (smag > np) np = smag;
 		}
 		if (np > a->peak) a->peak = np;
+		InterlockedIncrement (a->pmtseq);
 		a->result[a->enum_av] = a->avg;
 		a->result[a->enum_pk] = 10.0 * mlog10 (a->peak + 1.0e-40);
 		if ((a->pgain != 0) && (a->enum_gain >= 0))
 			a->result[a->enum_gain] = 20.0 * mlog10 (*a->pgain + 1.0e-40);
+		InterlockedIncrement (a->pmtseq);
 	}
 	else
 	{
+		InterlockedIncrement (a->pmtseq);
 		if (a->enum_av   >= 0) a->result[a->enum_av]   = - 400.0;
 		if (a->enum_pk   >= 0) a->result[a->enum_pk]   = - 400.0;
 		if (a->enum_gain >= 0) a->result[a->enum_gain] = +   0.0;
+		InterlockedIncrement (a->pmtseq);
 	}
-	LeaveCriticalSection (&a->mtupdate);
+}
+
+/********************************************************************************************************
+*																										*
+*	The results of all the meters of a channel are published under one sequence counter (seqlock):		*
+*	the DSP thread makes it odd before and even after writing, readers retry until they have seen the	*
+*	same even value before and after copying.  Readers never block the DSP thread.						*
+*																										*
+********************************************************************************************************/
+
+void read_meters (volatile long* pmtseq, float* result, int first, int count, float* meters)
+{
+	long seq;
+	int i;
+	do
+	{
+		while ((seq = *pmtseq) & 1) ;
+		MemoryBarrier ();
+		for (i = 0; i < count; i++)
+			meters[i] = result[first + i];
+		MemoryBarrier ();
+	} while (seq != *pmtseq);
 }
 
 /********************************************************************************************************
@@ -112,13 +134,16 @@ PORT
 float GetRXAMeter (int channel, int mt)
 {
 	float val;
-	CRITICAL_SECTION* a = rxa[channel].pmtupdate[mt];
-	EnterCriticalSection (a);
-	val = rxa[channel].meter[mt];
-	LeaveCriticalSection (a);
+	read_meters (&rxa[channel].mtseq, rxa[channel].meter, mt, 1, &val);
 	return val;
 }
 
+PORT
+void GetRXAMeters (int channel, float* meters)
+{
+	read_meters (&rxa[channel].mtseq, rxa[channel].meter, 0, RXA_METERTYPE_LAST, meters);
+}
+
 /********************************************************************************************************
 *																										*
 *											TXA Properties												*
@@ -129,9 +154,12 @@ PORT
 float GetTXAMeter (int channel, int mt)
 {
 	float val;
-	CRITICAL_SECTION* a = txa[channel].pmtupdate[mt];
-	EnterCriticalSection (a);
-	val = txa[channel].meter[mt];
-	LeaveCriticalSection (a);
+	read_meters (&txa[channel].mtseq, txa[channel].meter, mt, 1, &val);
 	return val;
+}
+
+PORT
+void GetTXAMeters (int channel, float* meters)
+{
+	read_meters (&txa[channel].mtseq, txa[channel].meter, 0, TXA_METERTYPE_LAST, meters);
 }
\ No newline at end of file
@@ -45,10 +45,10 @@ typedef struct _meter
 	float* pgain;
 	float avg;
 	float peak;
-	CRITICAL_SECTION mtupdate;
+	volatile long* pmtseq;		// channel sequence counter, odd while the results are being written
 } meter, *METER;
 
-extern METER create_meter (int run, int* prun, int size, float* buff, int rate, float tau_av, float tau_decay, float* result, CRITICAL_SECTION** pmtupdate, int enum_av, int enum_pk, int enum_gain, float* pgain);
+extern METER create_meter (int run, int* prun, int size, float* buff, int rate, float tau_av, float tau_decay, float* result, volatile long* pmtseq, int enum_av, int enum_pk, int enum_gain, float* pgain);
 
 extern void destroy_meter (METER a);
 
@@ -56,12 +56,18 @@ extern void flush_meter (METER a);
 
 extern void xmeter (METER a);
 
+extern void read_meters (volatile long* pmtseq, float* result, int first, int count, float* meters);
+
 // RXA Properties
 
 extern __declspec (dllexport) float GetRXAMeter (int channel, int mt);
 
+extern __declspec (dllexport) void GetRXAMeters (int channel, float* meters);
+
 // TXA Properties
 
 extern __declspec (dllexport) float GetTXAMeter (int channel, int mt);
 
+extern __declspec (dllexport) void GetTXAMeters (int channel, float* meters);
+
 #endif
\ No newline at end of file
@@ -29,6 +29,7 @@ warren@wpratt.com
 #define MAX_TAU			(0.002)		// maximum transition time, signal<->zero
 #define MAX_ADVTIME		(0.002)		// maximum deadtime (zero output) in advance of detected noise
 #define MAX_SAMPLERATE  (384000)
+#define ANB_BLOCK		(64)		// block size of the detection scan while no noise is present
 
 void initBlanker(ANB a)
 {
@@ -45,6 +46,9 @@ void initBlanker(ANB a)
     a->power = 1.0;
     a->backmult = exp(-1.0 / (a->samplerate * a->backtau));
     a->ombackmult = 1.0 - a->backmult;
+	a->blockmult = pow(a->backmult, ANB_BLOCK);
+	for (i = 0; i < ANB_BLOCK; i++)
+		a->blockwt[i] = a->ombackmult * pow(a->backmult, ANB_BLOCK - 1 - i);
     for (i = 0; i <= a->trans_count; i++)
         a->wave[i] = 0.5 * cos(i * a->coef);
 	memset(a->dline, 0, a->dline_size * sizeof(complex));
@@ -79,6 +83,7 @@ ANB create_anb	(
 	a->wave = (float *) malloc0 (((int)(MAX_SAMPLERATE * MAX_TAU) + 1) * sizeof(float));
 	a->dline_size = (int)((MAX_TAU + MAX_ADVTIME) * MAX_SAMPLERATE) + 1;
 	a->dline = (float *) malloc0 (a->dline_size * sizeof(complex));
+	a->blockwt = (float *) malloc0 (ANB_BLOCK * sizeof(float));
 	InitializeCriticalSectionAndSpinCount (&a->cs_update, 2500);
 	initBlanker(a);
 	a->legacy = (float *) malloc0 (2048 * sizeof (complex));														/////////////// legacy interface - remove
@@ -90,6 +95,7 @@ void destroy_anb (ANB a)
 { 
 	DeleteCriticalSection (&a->cs_update);
 	_aligned_free (a->legacy);																						/////////////// legacy interface - remove
+	_aligned_free (a->blockwt);
 	_aligned_free (a->dline);
 	_aligned_free (a->wave);
 	_aligned_free (a);
@@ -103,106 +109,266 @@ void flush_anb (ANB a)
 	LeaveCriticalSection (&a->cs_update);
 }
 
-PORT
-void xanb (ANB a)
+static void anb_delay (ANB a, int start, int n)
 {
-    float scale;
-    float mag;
-	int i;
-    if (a->run)
+	// passes 'n' samples through the delay line unchanged; 'n' must not exceed
+	// (dline_size - trans_count - adv_count) so that no sample is overwritten before it is read
+	int first;
+	first = a->dline_size - a->in_idx;
+	if (first > n) first = n;
+	memcpy (a->dline + 2 * a->in_idx, a->in + 2 * start, first * sizeof (complex));
+	memcpy (a->dline, a->in + 2 * (start + first), (n - first) * sizeof (complex));
+	if ((a->in_idx += n) >= a->dline_size) a->in_idx -= a->dline_size;
+	first = a->dline_size - a->out_idx;
+	if (first > n) first = n;
+	memcpy (a->out + 2 * start, a->dline + 2 * a->out_idx, first * sizeof (complex));
+	memcpy (a->out + 2 * (start + first), a->dline, (n - first) * sizeof (complex));
+	if ((a->out_idx += n) >= a->dline_size) a->out_idx -= a->dline_size;
+}
+
+static int anb_quiet (ANB a, int start)
+{
+	// while idle, scans the input in blocks and passes the samples preceding the
+	// first detection through the delay line in bulk; returns the number of samples consumed
+	float mag[ANB_BLOCK];
+	float avg, next, peak, sum;
+	int i, j, n, limit;
+	limit = a->dline_size - a->trans_count - a->adv_count;
+	if (limit > ANB_BLOCK) limit = ANB_BLOCK;
+	i = start;
+	while (i < a->buffsize)
 	{
-		EnterCriticalSection (&a->cs_update);
-		for (i = 0; i < a->buffsize; i++)
+		n = a->buffsize - i;
+		if (n > limit) n = limit;
+		for (j = 0; j < n; j++)
+			mag[j] = sqrt(a->in[2 * (i + j) + 0] * a->in[2 * (i + j) + 0] + a->in[2 * (i + j) + 1] * a->in[2 * (i + j) + 1]);
+		if (n == ANB_BLOCK)
+		{
+			// no average within the block can fall below 'blockmult * avg', so a block whose peak
+			// stays under that times the threshold cannot trigger; its new average is a weighted sum
+			peak = 0.0;
+			sum = 0.0;
+			for (j = 0; j < n; j++)
+			{
+				if (mag[j] > peak) peak = mag[j];
+				sum += a->blockwt[j] * mag[j];
+			}
+			if (peak <= a->threshold * a->blockmult * a->avg)
+			{
+				a->avg = a->blockmult * a->avg + sum;
+				anb_delay (a, i, n);
+				i += n;
+				continue;
+			}
+		}
+		avg = a->avg;
+		for (j = 0; j < n; j++)
 		{
-			mag = sqrt(a->in[2 * i + 0] * a->in[2 * i + 0] + a->in[2 * i + 1] * a->in[2 * i + 1]);
-			a->avg = a->backmult * a->avg + a->ombackmult * mag;
-			a->dline[2 * a->in_idx + 0] = a->in[2 * i + 0];
-			a->dline[2 * a->in_idx + 1] = a->in[2 * i + 1];
-			if (mag > (a->avg * a->threshold))
-				a->count = a->trans_count + a->adv_count;
-
-			switch (a->state)
+			next = a->backmult * avg + a->ombackmult * mag[j];
+			if (mag[j] > (next * a->threshold))
+				break;
+			avg = next;
+		}
+		a->avg = avg;
+		anb_delay (a, i, j);
+		i += j;
+		if (j < n) break;
+	}
+	return i - start;
+}
+
+static void anb_step (ANB a, int i)
+{
+	float scale;
+	float mag;
+	mag = sqrt(a->in[2 * i + 0] * a->in[2 * i + 0] + a->in[2 * i + 1] * a->in[2 * i + 1]);
+	a->avg = a->backmult * a->avg + a->ombackmult * mag;
+	a->dline[2 * a->in_idx + 0] = a->in[2 * i + 0];
+	a->dline[2 * a->in_idx + 1] = a->in[2 * i + 1];
+	if (mag > (a->avg * a->threshold))
+		a->count = a->trans_count + a->adv_count;
+
+	switch (a->state)
+	{
+		case 0:
+			a->out[2 * i + 0] = a->dline[2 * a->out_idx + 0];
+			a->out[2 * i + 1] = a->dline[2 * a->out_idx + 1];
+			if (a->count > 0)
 			{
-				case 0:
-					a->out[2 * i + 0] = a->dline[2 * a->out_idx + 0];
-					a->out[2 * i + 1] = a->dline[2 * a->out_idx + 1];
-					if (a->count > 0)
-					{
-						a->state = 1;
-						a->dtime = 0;
-						a->power = 1.0;
-					}
-					break;
-				case 1:
-					scale = a->power * (0.5 + a->wave[a->dtime]);
-					a->out[2 * i + 0] = a->dline[2 * a->out_idx + 0] * scale;
-					a->out[2 * i + 1] = a->dline[2 * a->out_idx + 1] * scale;
-					if (++a->dtime > a->trans_count)
-					{
-						a->state = 2;
-						a->atime = 0;
-					}
-					break;
-				case 2:
-					a->out[2 * i + 0] = 0.0;
-					a->out[2 * i + 1] = 0.0;
-					if (++a->atime > a->adv_count)
-						a->state = 3;
-					break;
-				case 3:
-					if (a->count > 0)
-						a->htime = -a->count;
-                                
-					a->out[2 * i + 0] = 0.0;
-					a->out[2 * i + 1] = 0.0;
-					if (++a->htime > a->hang_count)
-					{
-						a->state = 4;
-						a->itime = 0;
-					}
-					break;
-				case 4:
-					scale = 0.5 - a->wave[a->itime];
-					a->out[2 * i + 0] = a->dline[2 * a->out_idx + 0] * scale;
-					a->out[2 * i + 1] = a->dline[2 * a->out_idx + 1] * scale;
-					if (a->count > 0)
-					{
-						a->state = 1;
-						a->dtime = 0;
-						a->power = scale;
-					}
-					else if (++a->itime > a->trans_count)
-						a->state = 0;
-					break;
+				a->state = 1;
+				a->dtime = 0;
+				a->power = 1.0;
 			}
-			if (a->count > 0) a->count--;
-			if (++a->in_idx == a->dline_size) a->in_idx = 0; 
-			if (++a->out_idx == a->dline_size) a->out_idx = 0;
+			break;
+		case 1:
+			scale = a->power * (0.5 + a->wave[a->dtime]);
+			a->out[2 * i + 0] = a->dline[2 * a->out_idx + 0] * scale;
+			a->out[2 * i + 1] = a->dline[2 * a->out_idx + 1] * scale;
+			if (++a->dtime > a->trans_count)
+			{
+				a->state = 2;
+				a->atime = 0;
+			}
+			break;
+		case 2:
+			a->out[2 * i + 0] = 0.0;
+			a->out[2 * i + 1] = 0.0;
+			if (++a->atime > a->adv_count)
+				a->state = 3;
+			break;
+		case 3:
+			if (a->count > 0)
+				a->htime = -a->count;
+                        
+			a->out[2 * i + 0] = 0.0;
+			a->out[2 * i + 1] = 0.0;
+			if (++a->htime > a->hang_count)
+			{
+				a->state = 4;
+				a->itime = 0;
+			}
+			break;
+		case 4:
+			scale = 0.5 - a->wave[a->itime];
+			a->out[2 * i + 0] = a->dline[2 * a->out_idx + 0] * scale;
+			a->out[2 * i + 1] = a->dline[2 * a->out_idx + 1] * scale;
+			if (a->count > 0)
+			{
+				a->state = 1;
+				a->dtime = 0;
+				a->power = scale;
+			}
+			else if (++a->itime > a->trans_count)
+				a->state = 0;
+			break;
+	}
+	if (a->count > 0) a->count--;
+	if (++a->in_idx == a->dline_size) a->in_idx = 0; 
+	if (++a->out_idx == a->dline_size) a->out_idx = 0;
+}
+
+static void anb_scan (ANB a)
+{
+	// equivalent to calling anb_step() for every sample up to rounding:  the block average is a
+	// weighted sum rather than 64 recursive updates, so a sample within rounding of the threshold
+	// may trigger one sample earlier or later than in the per-sample loop
+	int i;
+	i = 0;
+	while (i < a->buffsize)
+	{
+		// impulses are rare:  only the samples around a detection go through the state machine
+		if (a->state == 0 && a->count == 0)
+		{
+			i += anb_quiet (a, i);
+			if (i == a->buffsize) break;
 		}
+		anb_step (a, i++);
+	}
+}
+
+#ifdef ANB_CHECK
+#define ANB_TOLERANCE	(1.0e-3)	// largest output difference accepted by anb_check(), relative to the peak output
+
+static void anb_check (ANB a)
+{
+	// runs anb_scan() and then the per-sample reference loop on the same input and state, reports
+	// buffers whose outputs differ by more than ANB_TOLERANCE and keeps the reference output
+	float *in, *dline, *fast;
+	float avg, power, diff, peak, d;
+	int state, count, dtime, htime, itime, atime, in_idx, out_idx;
+	int i;
+	in = (float *) malloc0 (a->buffsize * sizeof (complex));
+	fast = (float *) malloc0 (a->buffsize * sizeof (complex));
+	dline = (float *) malloc0 (a->dline_size * sizeof (complex));
+	memcpy (in, a->in, a->buffsize * sizeof (complex));
+	memcpy (dline, a->dline, a->dline_size * sizeof (complex));
+	avg = a->avg; power = a->power; state = a->state; count = a->count;
+	dtime = a->dtime; htime = a->htime; itime = a->itime; atime = a->atime;
+	in_idx = a->in_idx; out_idx = a->out_idx;
+	anb_scan (a);
+	memcpy (fast, a->out, a->buffsize * sizeof (complex));
+	memcpy (a->in, in, a->buffsize * sizeof (complex));
+	memcpy (a->dline, dline, a->dline_size * sizeof (complex));
+	a->avg = avg; a->power = power; a->state = state; a->count = count;
+	a->dtime = dtime; a->htime = htime; a->itime = itime; a->atime = atime;
+	a->in_idx = in_idx; a->out_idx = out_idx;
+	for (i = 0; i < a->buffsize; i++)
+		anb_step (a, i);
+	diff = 0.0;
+	peak = 0.0;
+	for (i = 0; i < 2 * a->buffsize; i++)
+	{
+		if ((d = fabs (a->out[i] - fast[i])) > diff) diff = d;
+		if ((d = fabs (a->out[i])) > peak) peak = d;
+	}
+	if (diff > ANB_TOLERANCE * peak)
+		fprintf (stderr, "anb: block scan differs from the per-sample loop by %e (peak %e)\n", diff, peak);
+	_aligned_free (dline);
+	_aligned_free (fast);
+	_aligned_free (in);
+}
+#endif
+
+PORT
+void xanb (ANB a)
+{
+    if (a->run)
+	{
+		EnterCriticalSection (&a->cs_update);
+#ifdef ANB_CHECK
+		anb_check (a);
+#else
+		anb_scan (a);
+#endif
 		LeaveCriticalSection (&a->cs_update);
 	}
 	else if (a->in != a->out)
 		memcpy (a->out, a->in, a->buffsize * sizeof (complex));
 }
 
-
 /********************************************************************************************************
 *																										*
 *											  RXA PROPERTIES											*
 *																										*
 ********************************************************************************************************/
 
-// The following is an example to follow for properties in the event that this function is used inside
-// a channel.
-
-// PORT
-// void SetRXAANBRun (int channel, int run)
-// {
-//	 ANB a = rxa[channel].anb.p;
-//	 EnterCriticalSection (&a->cs_update);
-//	 a->run = run;
-//	 LeaveCriticalSection (&a->cs_update);
-// }
+PORT
+void SetRXAANBRun (int channel, int run)
+{
+	ANB a = rxa[channel].anb.p;
+	EnterCriticalSection (&a->cs_update);
+	a->run = run;
+	LeaveCriticalSection (&a->cs_update);
+}
+
+PORT
+void SetRXAANBThreshold (int channel, float thresh)
+{
+	ANB a = rxa[channel].anb.p;
+	EnterCriticalSection (&a->cs_update);
+	a->threshold = thresh;
+	LeaveCriticalSection (&a->cs_update);
+}
+
+PORT
+void SetRXAANBHangtime (int channel, float time)
+{
+	ANB a = rxa[channel].anb.p;
+	EnterCriticalSection (&a->cs_update);
+	a->hangtime = time;
+	initBlanker (a);
+	LeaveCriticalSection (&a->cs_update);
+}
+
+PORT
+void SetRXAANBAdvtime (int channel, float time)
+{
+	ANB a = rxa[channel].anb.p;
+	EnterCriticalSection (&a->cs_update);
+	a->advtime = time;
+	initBlanker (a);
+	LeaveCriticalSection (&a->cs_update);
+}
 
 /********************************************************************************************************
 *																										*
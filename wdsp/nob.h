@@ -58,6 +58,8 @@ typedef struct _anb
     int count;						// set each time a noise sample is detected, counts down
     float backmult;				// multiplier for waveform averaging
     float ombackmult;				// multiplier for waveform averaging
+	float blockmult;				// decay of the average over one block of the detection scan
+	float *blockwt;					// weights giving the average at the end of such a block
 	CRITICAL_SECTION cs_update;
 	float *legacy;																										////////////  legacy interface - remove
 } anb, *ANB;
@@ -100,6 +102,15 @@ extern __declspec (dllexport) void flush_anbEXT (int id);
 extern __declspec (dllexport) void xanbEXT (int id, float* in, float* out);
 
 
+extern __declspec (dllexport) void SetRXAANBRun (int channel, int run);
+
+extern __declspec (dllexport) void SetRXAANBThreshold (int channel, float thresh);
+
+extern __declspec (dllexport) void SetRXAANBHangtime (int channel, float time);
+
+extern __declspec (dllexport) void SetRXAANBAdvtime (int channel, float time);
+
+
 extern __declspec (dllexport) void pSetRCVRANBRun (ANB a, int run);
 
 extern __declspec (dllexport) void pSetRCVRANBBuffsize (ANB a, int size);
@@ -0,0 +1,144 @@
+/*  pfb.c
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2015 Pavel Demin
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#include "comm.h"
+
+/********************************************************************************************************
+*																										*
+*								Polyphase Filterbank Channelizer										*
+*																										*
+*	Splits a complex stream at rate 'fs' into 'nc' channels centered at k * fs / nc (channels above		*
+*	nc / 2 are the negative frequencies).  Each channel is decimated by nc / over, so 'over' = 1 gives	*
+*	a critically sampled and 'over' = 2 a 2x oversampled filterbank.  For every output sample the		*
+*	windowed input history is folded into nc points and a single FFT yields all the channels.			*
+*	'size' must be a multiple of nc / over.																*
+*																										*
+********************************************************************************************************/
+
+PFB create_pfb (int run, int size, float* in, int nc, int over, int ntaps)
+{
+	PFB a = (PFB) malloc0 (sizeof (pfb));
+	float* impulse;
+	int ncoef;
+	a->run = run;
+	a->size = size;
+	a->in = in;
+	a->nc = nc;
+	a->over = over;
+	a->dec = nc / over;
+	a->ntaps = ntaps;
+	a->nout = size / a->dec;
+	ncoef = a->nc * a->ntaps;
+	impulse = fir_bandpass (ncoef, -0.5 / (float)nc, +0.5 / (float)nc, 1.0, 0, 0, 1.0);
+	a->h = (float *) malloc0 (ncoef * sizeof (float));
+	memcpy (a->h, impulse, ncoef * sizeof (float));
+	_aligned_free (impulse);
+	a->hist = (float *) malloc0 ((ncoef - 1 + a->size) * sizeof (complex));
+	a->fold = (float *) malloc0 (a->nout * a->nc * sizeof (complex));
+	a->out  = (float *) malloc0 (a->nout * a->nc * sizeof (complex));
+	EnterPlanner ();
+	a->p = fftwf_plan_many_dft (1, &a->nc, a->nout,
+		(fftwf_complex *)a->fold, NULL, 1, a->nc,
+		(fftwf_complex *)a->out,  NULL, 1, a->nc,
+		FFTW_BACKWARD, FFTW_ESTIMATE);
+	LeavePlanner ();
+	a->count = 0;
+	return a;
+}
+
+void destroy_pfb (PFB a)
+{
+	EnterPlanner ();
+	fftwf_destroy_plan (a->p);
+	LeavePlanner ();
+	_aligned_free (a->out);
+	_aligned_free (a->fold);
+	_aligned_free (a->hist);
+	_aligned_free (a->h);
+	_aligned_free (a);
+}
+
+void flush_pfb (PFB a)
+{
+	memset (a->hist, 0, (a->nc * a->ntaps - 1 + a->size) * sizeof (complex));
+	memset (a->out, 0, a->nout * a->nc * sizeof (complex));
+	a->count = 0;
+}
+
+void xpfb (PFB a)
+{
+	if (a->run)
+	{
+		int i, j, k, r;
+		int ncoef = a->nc * a->ntaps;
+		float I, Q;
+		float* x;
+		float* u;
+		memcpy (a->hist + 2 * (ncoef - 1), a->in, a->size * sizeof (complex));
+		for (j = 0; j < a->nout; j++)
+		{
+			// x[-n] is the input sample n samples before the newest one of this output
+			x = a->hist + 2 * (ncoef - 1 + (j + 1) * a->dec - 1);
+			u = a->fold + 2 * j * a->nc;
+			for (r = 0; r < a->nc; r++)
+			{
+				I = 0.0;
+				Q = 0.0;
+				for (i = r; i < ncoef; i += a->nc)
+				{
+					I += a->h[i] * x[-2 * i + 0];
+					Q += a->h[i] * x[-2 * i + 1];
+				}
+				u[2 * r + 0] = I;
+				u[2 * r + 1] = Q;
+			}
+		}
+		memmove (a->hist, a->hist + 2 * a->size, (ncoef - 1) * sizeof (complex));
+		fftwf_execute (a->p);
+		if (a->over == 2)
+		{
+			// the output of channel k rotates by pi * k for every nc / 2 input samples
+			for (j = 0; j < a->nout; j++, a->count ^= 1)
+			{
+				if (!a->count) continue;
+				u = a->out + 2 * j * a->nc;
+				for (k = 1; k < a->nc; k += 2)
+				{
+					u[2 * k + 0] = - u[2 * k + 0];
+					u[2 * k + 1] = - u[2 * k + 1];
+				}
+			}
+		}
+	}
+}
+
+int pfb_channel (PFB a, int k, float* out)
+{
+	int j;
+	if (!a->run || k < 0 || k >= a->nc) return 0;
+	for (j = 0; j < a->nout; j++)
+	{
+		out[2 * j + 0] = a->out[2 * (j * a->nc + k) + 0];
+		out[2 * j + 1] = a->out[2 * (j * a->nc + k) + 1];
+	}
+	return a->nout;
+}
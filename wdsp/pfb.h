@@ -0,0 +1,54 @@
+/*  pfb.h
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2015 Pavel Demin
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#ifndef _pfb_h
+#define _pfb_h
+
+typedef struct _pfb
+{
+	int run;
+	int size;			// number of input samples per buffer
+	float* in;			// input buffer
+	int nc;				// number of channels
+	int over;			// oversampling factor, 1 or 2
+	int dec;			// decimation factor, nc / over
+	int ntaps;			// taps per polyphase branch
+	int nout;			// output samples per channel per buffer, size / dec
+	int count;			// output sample counter, for the 2x phase correction
+	float* h;			// prototype lowpass, nc * ntaps real coefficients
+	float* hist;		// last nc * ntaps - 1 input samples followed by the current buffer
+	float* fold;		// folded input, nout blocks of nc complex samples
+	float* out;			// channel outputs, nout blocks of nc complex samples
+	fftwf_plan p;		// one plan transforming all the blocks of a buffer
+} pfb, *PFB;
+
+extern PFB create_pfb (int run, int size, float* in, int nc, int over, int ntaps);
+
+extern void destroy_pfb (PFB a);
+
+extern void flush_pfb (PFB a);
+
+extern void xpfb (PFB a);
+
+extern int pfb_channel (PFB a, int k, float* out);
+
+#endif
@@ -63,7 +63,9 @@ SIPHON create_siphon (int run, int insize, float* in, int sipsize, int fftsize,
 	a->fftsize = fftsize;
 	a->specout = (float *) malloc0 (a->fftsize * sizeof (complex));
 	a->specmode = specmode;
+	EnterPlanner ();
 	a->sipplan = fftwf_plan_dft_1d (a->fftsize, (fftwf_complex *)a->sipout, (fftwf_complex *)a->specout, FFTW_FORWARD, FFTW_PATIENT);
+	LeavePlanner ();
 	a->window  = (float *) malloc0 (a->fftsize * sizeof (complex));
 	InitializeCriticalSectionAndSpinCount(&a->update, 2500);
 	build_window (a);
@@ -73,7 +75,9 @@ SIPHON create_siphon (int run, int insize, float* in, int sipsize, int fftsize,
 void destroy_siphon (SIPHON a)
 {
 	DeleteCriticalSection(&a->update);
+	EnterPlanner ();
 	fftwf_destroy_plan (a->sipplan);
+	LeavePlanner ();
 	_aligned_free (a->window);
 	_aligned_free (a->specout);
 	_aligned_free (a->sipout);
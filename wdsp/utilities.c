@@ -42,6 +42,35 @@ void *malloc0 (int size)
 	return p;
 }
 
+// The FFTW planner keeps global state and is not thread-safe, while plans are made by the setters,
+// by channel rebuilds and by the analyzer, possibly on different threads and without csDSP held.
+// Every fftwf_plan_* and fftwf_destroy_plan call is made between EnterPlanner() and LeavePlanner().
+
+static CRITICAL_SECTION csPlanner;
+static volatile long planner_state;		// 0 = not initialized, 1 = being initialized, 2 = ready
+
+void EnterPlanner (void)
+{
+	if (planner_state != 2)
+	{
+		if (InterlockedCompareExchange (&planner_state, 1, 0) == 0)
+		{
+			InitializeCriticalSectionAndSpinCount (&csPlanner, 2500);
+			MemoryBarrier ();
+			planner_state = 2;
+		}
+		else
+			while (planner_state != 2)
+				Sleep (1);
+	}
+	EnterCriticalSection (&csPlanner);
+}
+
+void LeavePlanner (void)
+{
+	LeaveCriticalSection (&csPlanner);
+}
+
 // Exported calls
 
 #ifndef linux
@@ -162,7 +191,7 @@ void print_buffer_parameters (const char* filename, int channel)
 	fprintf (file, "r1_unqueuedsamps   = %d\n", a->r1_unqueuedsamps);
 	fprintf (file, "r2_inidx           = %d\n", a->r2_inidx);
 	fprintf (file, "r2_outidx          = %d\n", a->r2_outidx);
-	fprintf (file, "r2_havesamps       = %d\n", a->r2_havesamps);
+	fprintf (file, "r2_havesamps       = %d\n", (int)a->r2_havesamps);
 	fprintf (file, "in_rate            = %d\n", ch[channel].in_rate);
 	fprintf (file, "dsp_rate           = %d\n", ch[channel].dsp_rate);
 	fprintf (file, "out_rate           = %d\n", ch[channel].out_rate);
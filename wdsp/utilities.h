@@ -26,6 +26,10 @@ warren@wpratt.com
 
 __declspec (dllexport) void *malloc0 (int size);
 
+extern void EnterPlanner (void);
+
+extern void LeavePlanner (void);
+
 extern void print_impulse (const char* filename, int N, float* impulse, int rtype, int pr_mode);
 
 void print_peak_val(const char* filename, int N, float* buff, float thresh);
@@ -0,0 +1,238 @@
+/*  wfmd.c
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2015 Pavel Demin
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#include "comm.h"
+
+/********************************************************************************************************
+*																										*
+*								Wideband FM Broadcast Demodulator										*
+*																										*
+*	Demodulates a broadcast FM station sampled at 'rate' (250 kHz on the Red Pitaya) to the composite	*
+*	signal with a polar discriminator, locks a pll to the 19 kHz pilot and recovers L-R from the		*
+*	38 kHz subcarrier with the doubled pilot phase.  L+R and L-R are low-pass filtered and decimated	*
+*	by 4 and then by 2 with windowed-sinc FIRs that are evaluated only at the output samples; the		*
+*	second stage removes the pilot before it can alias.  The stereo output at rate / 8 is de-emphasized.*
+*																										*
+********************************************************************************************************/
+
+#define WFMD_TABLE		(4096)		// size of the sine table of the pll oscillator
+
+static __forceinline float wfmd_atan2 (float y, float x)
+{
+	// polynomial approximation of atan on [0, 1], the error stays below 1e-5 radians
+	float ax = fabs (x);
+	float ay = fabs (y);
+	float z, z2, r;
+	z = (ax < ay ? ax : ay) / ((ax < ay ? ay : ax) + 1.0e-30);
+	z2 = z * z;
+	r = z * (0.9998660 + z2 * (-0.3302995 + z2 * (0.1801410 + z2 * (-0.0851330 + z2 * 0.0208351))));
+	if (ay > ax) r = 0.5 * PI - r;
+	if (x < 0.0) r = PI - r;
+	if (y < 0.0) r = -r;
+	return r;
+}
+
+static float* wfmd_lowpass (int N, float fc, float rate)
+{
+	// real low-pass coefficients with unity gain at DC
+	float* impulse = fir_bandpass (N, -fc, +fc, rate, 0, 0, 1.0);
+	float* c = (float *) malloc0 (N * sizeof (float));
+	float sum = 0.0;
+	int i;
+	for (i = 0; i < N; i++)
+		sum += impulse[i];
+	for (i = 0; i < N; i++)
+		c[i] = impulse[i] / sum;
+	_aligned_free (impulse);
+	return c;
+}
+
+WFMD create_wfmd (int run, int size, float* in, float* out, int rate, float deviation, float tau, int stereo)
+{
+	WFMD a = (WFMD) malloc0 (sizeof (wfmd));
+	float omegaN, zeta;
+	int i;
+	a->run = run;
+	a->size = size;
+	a->in = in;
+	a->out = out;
+	a->rate = (float)rate;
+	a->deviation = deviation;
+	a->again = a->rate / (a->deviation * TWOPI);
+	a->mpx = (float *) malloc0 (a->size * sizeof (float));
+	// pilot pll, as in fmd with a loop of about 30 Hz
+	omegaN = 200.0;
+	zeta = 0.707;
+	a->omega_min = TWOPI * 18900.0 / a->rate;
+	a->omega_max = TWOPI * 19100.0 / a->rate;
+	a->g1 = 1.0 - exp(-2.0 * omegaN * zeta / a->rate);
+	a->g2 = -a->g1 + 2.0 * (1 - exp(-omegaN * zeta / a->rate) * cos(omegaN / a->rate * sqrt(1.0 - zeta * zeta)));
+	a->pmult = exp (-1.0 / (a->rate * 0.05));
+	a->stereo = stereo;
+	a->table = (float *) malloc0 (WFMD_TABLE * sizeof (float));
+	for (i = 0; i < WFMD_TABLE; i++)
+		a->table[i] = sin (TWOPI * i / WFMD_TABLE);
+	// first stage passes 15 kHz and stops at rate / 4 - 15 kHz, second stage passes 14 kHz and stops at rate / 8 - 14 kHz
+	a->ncoef1 = 31;
+	a->ncoef2 = 79;
+	a->c1 = wfmd_lowpass (a->ncoef1, 0.125 * a->rate, a->rate);
+	a->c2 = wfmd_lowpass (a->ncoef2, 0.0625 * a->rate, 0.25 * a->rate);
+	a->ring1 = (float *) malloc0 (4 * a->ncoef1 * sizeof (float));
+	a->ring2 = (float *) malloc0 (4 * a->ncoef2 * sizeof (float));
+	pSetWFMDDeemphasis (a, tau);
+	flush_wfmd (a);
+	return a;
+}
+
+void destroy_wfmd (WFMD a)
+{
+	_aligned_free (a->ring2);
+	_aligned_free (a->ring1);
+	_aligned_free (a->c2);
+	_aligned_free (a->c1);
+	_aligned_free (a->table);
+	_aligned_free (a->mpx);
+	_aligned_free (a);
+}
+
+void flush_wfmd (WFMD a)
+{
+	a->last[0] = 0.0;
+	a->last[1] = 0.0;
+	a->phs = 0.0;
+	a->omega = TWOPI * 19000.0 / a->rate;
+	a->pilot = 0.0;
+	a->blend = 0.0;
+	memset (a->ring1, 0, 4 * a->ncoef1 * sizeof (float));
+	memset (a->ring2, 0, 4 * a->ncoef2 * sizeof (float));
+	a->idx1 = 0;
+	a->idx2 = 0;
+	a->phase1 = 0;
+	a->phase2 = 0;
+	a->de[0] = 0.0;
+	a->de[1] = 0.0;
+}
+
+void xwfmd (WFMD a)
+{
+	if (a->run)
+	{
+		int i, j, k, n1, n2;
+		float re, im, det, pll, sub, m, s, left, right;
+		float *ring1m, *ring1s, *ring2m, *ring2s;
+		n1 = a->ncoef1;
+		n2 = a->ncoef2;
+		ring1m = a->ring1;
+		ring1s = a->ring1 + 2 * n1;
+		ring2m = a->ring2;
+		ring2s = a->ring2 + 2 * n2;
+		// discriminator, the phase step between successive samples
+		re = a->in[0] * a->last[0] + a->in[1] * a->last[1];
+		im = a->in[1] * a->last[0] - a->in[0] * a->last[1];
+		a->mpx[0] = a->again * wfmd_atan2 (im, re);
+		for (i = 1; i < a->size; i++)
+		{
+			re = a->in[2 * i + 0] * a->in[2 * i - 2] + a->in[2 * i + 1] * a->in[2 * i - 1];
+			im = a->in[2 * i + 1] * a->in[2 * i - 2] - a->in[2 * i + 0] * a->in[2 * i - 1];
+			a->mpx[i] = a->again * wfmd_atan2 (im, re);
+		}
+		a->last[0] = a->in[2 * a->size - 2];
+		a->last[1] = a->in[2 * a->size - 1];
+		for (i = 0; i < a->size; i++)
+		{
+			// pll on the pilot, which is (pilot * cos (phs)) when locked
+			k = (int)(a->phs * (WFMD_TABLE / TWOPI)) & (WFMD_TABLE - 1);
+			pll = a->table[(k + WFMD_TABLE / 4) & (WFMD_TABLE - 1)];
+			a->pilot = a->pmult * a->pilot + (1.0 - a->pmult) * 2.0 * a->mpx[i] * pll;
+			det = -2.0 * a->mpx[i] * a->table[k] / (a->pilot > 0.01 ? a->pilot : 0.01);
+			a->omega += a->g2 * det;
+			if (a->omega < a->omega_min) a->omega = a->omega_min;
+			if (a->omega > a->omega_max) a->omega = a->omega_max;
+			a->phs += a->g1 * det + a->omega;
+			while (a->phs >= TWOPI) a->phs -= TWOPI;
+			while (a->phs < 0.0) a->phs += TWOPI;
+			// the subcarrier is in phase with twice the pilot, that is -sin (2 * phs)
+			sub = -2.0 * a->table[(2 * k) & (WFMD_TABLE - 1)];
+			// first stage delay lines, doubled so that the last n1 samples are always contiguous
+			ring1m[a->idx1] = ring1m[a->idx1 + n1] = a->mpx[i];
+			ring1s[a->idx1] = ring1s[a->idx1 + n1] = a->mpx[i] * sub;
+			if (++a->idx1 == n1) a->idx1 = 0;
+			if (++a->phase1 < 4) continue;
+			a->phase1 = 0;
+			m = 0.0;
+			s = 0.0;
+			for (j = 0; j < n1; j++)
+			{
+				m += a->c1[j] * ring1m[a->idx1 + j];
+				s += a->c1[j] * ring1s[a->idx1 + j];
+			}
+			ring2m[a->idx2] = ring2m[a->idx2 + n2] = m;
+			ring2s[a->idx2] = ring2s[a->idx2 + n2] = s;
+			if (++a->idx2 == n2) a->idx2 = 0;
+			if (++a->phase2 < 2) continue;
+			a->phase2 = 0;
+			m = 0.0;
+			s = 0.0;
+			for (j = 0; j < n2; j++)
+			{
+				m += a->c2[j] * ring2m[a->idx2 + j];
+				s += a->c2[j] * ring2s[a->idx2 + j];
+			}
+			// fade to mono as the pilot disappears
+			if (a->stereo && a->pilot > 0.02)
+				a->blend = a->pilot < 0.04 ? (a->pilot - 0.02) / 0.02 : 1.0;
+			else
+				a->blend = 0.0;
+			s *= a->blend;
+			left  = m + s;
+			right = m - s;
+			if (a->tau > 0.0)
+			{
+				a->de[0] += a->demult * (left  - a->de[0]);
+				a->de[1] += a->demult * (right - a->de[1]);
+				left  = a->de[0];
+				right = a->de[1];
+			}
+			a->out[2 * (i / 8) + 0] = left;
+			a->out[2 * (i / 8) + 1] = right;
+		}
+	}
+	else
+		memset (a->out, 0, a->size / 8 * sizeof (complex));
+}
+
+/********************************************************************************************************
+*																										*
+*										POINTER-BASED PROPERTIES										*
+*																										*
+********************************************************************************************************/
+
+void pSetWFMDStereo (WFMD a, int stereo)
+{
+	a->stereo = stereo;
+}
+
+void pSetWFMDDeemphasis (WFMD a, float tau)
+{
+	a->tau = tau;
+	a->demult = tau > 0.0 ? 1.0 - exp (-8.0 / (a->rate * a->tau)) : 1.0;
+}
@@ -0,0 +1,74 @@
+/*  wfmd.h
+
+This file is part of a program that implements a Software-Defined Radio.
+
+Copyright (C) 2015 Pavel Demin
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+#ifndef _wfmd_h
+#define _wfmd_h
+
+typedef struct _wfmd
+{
+	int run;
+	int size;			// number of input samples per buffer, a multiple of 8
+	float* in;			// complex input at 'rate'
+	float* out;			// stereo output at rate / 8, size / 8 frames of left and right
+	float rate;			// input samplerate
+	float deviation;	// peak deviation of the broadcast
+	float again;		// discriminator gain, full deviation gives +-1
+	float last[2];		// last input sample, for the discriminator
+	float* mpx;			// demodulated composite signal
+	// pilot pll
+	float phs;			// pll - phase accumulator
+	float omega;		// pll - locked pilot frequency, radians per sample
+	float omega_min;	// pll - lowest pilot frequency to lock
+	float omega_max;	// pll - highest pilot frequency to lock
+	float g1, g2;		// pll - loop filter gains
+	float pilot;		// average pilot amplitude
+	float pmult;		// multiplier for pilot averaging
+	int stereo;			// decode L-R when the pilot is present
+	float blend;		// current amount of L-R, 0 = mono ... 1 = full stereo
+	float* table;		// sine table for the pll oscillator
+	// decimation, 'rate' to rate / 4 to rate / 8
+	int ncoef1, ncoef2;	// number of coefficients of the two stages
+	float* c1;			// low-pass coefficients of the first stage
+	float* c2;			// low-pass coefficients of the second stage
+	float* ring1;		// delay lines of the first stage, L+R then L-R, each of them doubled
+	float* ring2;		// delay lines of the second stage, same layout
+	int idx1, idx2;		// delay line positions
+	int phase1, phase2;	// decimation counters
+	// de-emphasis
+	float tau;			// de-emphasis time constant, 0 = off
+	float demult;		// de-emphasis filter coefficient
+	float de[2];		// de-emphasis filter state
+} wfmd, *WFMD;
+
+extern WFMD create_wfmd (int run, int size, float* in, float* out, int rate, float deviation, float tau, int stereo);
+
+extern void destroy_wfmd (WFMD a);
+
+extern void flush_wfmd (WFMD a);
+
+extern void xwfmd (WFMD a);
+
+extern void pSetWFMDStereo (WFMD a, int stereo);
+
+extern void pSetWFMDDeemphasis (WFMD a, float tau);
+
+#endif